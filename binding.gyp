@@ -9,7 +9,16 @@
         "src/odbc.cpp",
         "src/odbc_connection.cpp",
         "src/odbc_statement.cpp",
-        "src/odbc_result.cpp"
+        "src/odbc_result.cpp",
+        "src/parameter_stream.cpp",
+        "src/statement_cache.cpp",
+        "src/statement_pool.cpp",
+        "src/async_execution.cpp",
+        "src/query_canceller.cpp",
+        "src/executor.cpp",
+        "src/handle_lock.cpp",
+        "src/environment.cpp",
+        "src/metrics.cpp"
       ],
       "cflags": [
         "-Wall",
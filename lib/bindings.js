@@ -11,6 +11,10 @@ module.exports = {
     // Constants
     FETCH_ARRAY: bindings.FETCH_ARRAY,
     SQL_USER_NAME: bindings.SQL_USER_NAME,
+    SQL_TXN_READ_UNCOMMITTED: bindings.ODBC.SQL_TXN_READ_UNCOMMITTED,
+    SQL_TXN_READ_COMMITTED: bindings.ODBC.SQL_TXN_READ_COMMITTED,
+    SQL_TXN_REPEATABLE_READ: bindings.ODBC.SQL_TXN_REPEATABLE_READ,
+    SQL_TXN_SERIALIZABLE: bindings.ODBC.SQL_TXN_SERIALIZABLE,
 
     // dynodbc
     // loadODBCLibrary: bindings.loadODBCLibrary,
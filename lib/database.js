@@ -2,13 +2,29 @@ const { ODBC } = require('./bindings');
 
 class Database {
     constructor(options = {}) {
-        this.odbc = new ODBC();
+        // connections share the ODBC environment, and its thread pool, when
+        // one is passed in
+        this.odbc = options.odbc || new ODBC({
+            threadPoolSize: options.threadPoolSize,
+            globalLock: options.globalLock,
+            connectionPooling: options.connectionPooling,
+            poolMatch: options.poolMatch,
+            sharedEnvironment: options.sharedEnvironment,
+        });
         this.connected = false;
 
         // TODO Handle fetch Mode
         this.fetchMode = options.fetchMode;
         this.connectTimeout = options.connectTimeout;
         this.loginTimeout = options.loginTimeout;
+        this.statementCacheSize = options.statementCacheSize;
+        this.statementPoolSize = options.statementPoolSize;
+        this.asyncExecution = options.asyncExecution;
+        this.dedicatedThread = options.dedicatedThread;
+        this.readOnly = options.readOnly;
+
+        // a MetadataCache shared with other connections, usually by a pool
+        this.metadataCache = options.metadataCache;
     }
 
     async open(connectionString) {
@@ -18,10 +34,14 @@ class Database {
                 .reduce((acc, key) => `${acc}${key}=${connectionString[key]};`);
         }
 
-        this.co = await this.odbc.createConnection();
+        this.co = await this.odbc.createConnection({ dedicatedThread: !!this.dedicatedThread });
 
         if (this.connectTimeout || this.connectTimeout === 0) this.co.connectTimeout = this.connectTimeout;
         if (this.loginTimeout || this.loginTimeout === 0) this.co.loginTimeout = this.loginTimeout;
+        if (this.statementCacheSize) this.co.statementCacheSize = this.statementCacheSize;
+        if (this.statementPoolSize || this.statementPoolSize === 0) this.co.statementPoolSize = this.statementPoolSize;
+        if (this.asyncExecution) this.co.asyncExecution = true;
+        if (this.readOnly) this.co.readOnly = true;
 
         const res = await this.co.open(connectionString);
 
@@ -41,15 +61,78 @@ class Database {
         delete this.co;
     }
 
-    async query(sql, params) {
+    async query(sql, params, options) {
         this.assertConnection();
 
-        if (params) {
+        // params may be left out: query(sql, options)
+        if (Array.isArray(params)) {
+            return options ? this.co.query(sql, params, options) : this.co.query(sql, params);
+        }
+        return params ? this.co.query(sql, params) : this.co.query(sql);
+    }
 
-        } else {
+    async queryAll(sql, params, options) {
+        this.assertConnection();
 
+        // params may be left out: queryAll(sql, options)
+        if (Array.isArray(params)) {
+            return this.co.queryAll(sql, params, options || {});
         }
-        return this.co.query(sql, params);
+        return this.co.queryAll(sql, params || options || {});
+    }
+
+    async batch(statements, options = {}) {
+        this.assertConnection();
+        return this.co.batch(statements, options);
+    }
+
+    // autocommit is turned off for the whole connection while the statements
+    // run, so nothing else may run on this connection until it settles
+    async transaction(statements, options = {}) {
+        this.assertConnection();
+        return this.co.transaction(statements, options);
+    }
+
+    // resolves to false once the connection is closed or broken; probe is
+    // only run for drivers that don't support SQL_ATTR_CONNECTION_DEAD
+    async isAlive(probe) {
+        if (!this.co) return false;
+        return this.co.isAlive(probe);
+    }
+
+    // rolls back, turns autocommit back on and restores the isolation level,
+    // access mode and catalog the connection was opened with; resolves to the
+    // number of statement handles still in use
+    async reset() {
+        this.assertConnection();
+        return this.co.reset();
+    }
+
+    // prepares statements into the statement cache without running them
+    async cacheStatements(statements) {
+        this.assertConnection();
+        return this.co.cacheStatements(statements);
+    }
+
+    get statementCacheStats() {
+        return this.co ? this.co.statementCacheStats : undefined;
+    }
+
+    get statementPoolStats() {
+        return this.co ? this.co.statementPoolStats : undefined;
+    }
+
+    get threadPoolStats() {
+        return this.odbc.threadPoolStats;
+    }
+
+    // what the driver reported about itself when the connection was opened
+    get capabilities() {
+        return this.co ? this.co.capabilities : undefined;
+    }
+
+    get lockStats() {
+        return this.co ? this.co.lockStats : undefined;
     }
 
     async beginTransaction() {
@@ -68,12 +151,21 @@ class Database {
         return this.endTransaction(true);
     }
 
-    async columns(catalog, schema, table, column) {
+    // cached = false skips the metadata cache, when there is one
+    async columns(catalog, schema, table, column, cached = true) {
+        if (this.metadataCache && cached) {
+            return this.metadataCache.get('columns', [catalog, schema, table, column], () => this.columns(catalog, schema, table, column, false));
+        }
+
         const res = await this.co.columns(catalog, schema, table, column);
         return res.fetchAll();
     }
 
-    async tables(catalog, schema, table, type) {
+    async tables(catalog, schema, table, type, cached = true) {
+        if (this.metadataCache && cached) {
+            return this.metadataCache.get('tables', [catalog, schema, table, type], () => this.tables(catalog, schema, table, type, false));
+        }
+
         const res = await this.co.tables(catalog, schema, table, type);
         return res.fetchAll();
     }
@@ -0,0 +1,157 @@
+// Caches the rows of tables() and columns() calls, keyed on their arguments,
+// so catalog queries (expensive on some databases) run once per ttl instead
+// of on every call. One cache is shared by all connections of a pool.
+//
+// Concurrent calls for the same arguments share one catalog query. Entries
+// are dropped when they are older than ttl (0 keeps them until invalidated)
+// or by invalidate(), and the least recently used ones once there are more
+// than maxEntries; prefetch() loads every table and column of a schema in
+// two catalog queries and files the columns under each table.
+class MetadataCache {
+    constructor(options = {}) {
+        this.ttl = options.ttl === undefined ? 60000 : options.ttl;
+        this.maxEntries = options.maxEntries === undefined ? 1000 : options.maxEntries;
+        // key -> { kind, args, rows, loading, loadedAt }, least recently used first
+        this.entries = new Map();
+
+        this.counters = {
+            hits: 0,
+            misses: 0,
+            invalidations: 0,
+        };
+    }
+
+    get stats() {
+        return {
+            size: this.entries.size,
+            ttl: this.ttl,
+            maxEntries: this.maxEntries,
+            ...this.counters,
+        };
+    }
+
+    static normalize(args) {
+        return args.map(arg => (arg === undefined || arg === '' ? null : arg));
+    }
+
+    // resolves to the cached rows for kind ('tables' or 'columns') and args,
+    // calling load() to fetch them when they aren't cached
+    async get(kind, args, load) {
+        const normalized = MetadataCache.normalize(args);
+        const key = JSON.stringify([kind, ...normalized]);
+        let entry = this.entries.get(key);
+
+        if (entry && !entry.loading && this.isExpired(entry)) {
+            this.entries.delete(key);
+            entry = undefined;
+        }
+
+        if (entry) {
+            this.counters.hits += 1;
+
+            // most recently used goes last
+            this.entries.delete(key);
+            this.entries.set(key, entry);
+        } else {
+            this.counters.misses += 1;
+
+            entry = { kind, args: normalized, rows: null, loading: null, loadedAt: 0 };
+            entry.loading = load().then((rows) => {
+                entry.rows = rows;
+                entry.loading = null;
+                entry.loadedAt = Date.now();
+                return rows;
+            }, (error) => {
+                // failures aren't cached
+                if (this.entries.get(key) === entry) this.entries.delete(key);
+                throw error;
+            });
+
+            this.entries.set(key, entry);
+            this.prune();
+        }
+
+        const rows = entry.loading ? await entry.loading : entry.rows;
+
+        // callers get their own array, the rows themselves are shared
+        return rows.slice();
+    }
+
+    set(kind, args, rows) {
+        const normalized = MetadataCache.normalize(args);
+        const key = JSON.stringify([kind, ...normalized]);
+
+        this.entries.delete(key);
+        this.entries.set(key, {
+            kind,
+            args: normalized,
+            rows,
+            loading: null,
+            loadedAt: Date.now(),
+        });
+
+        this.prune();
+    }
+
+    isExpired(entry) {
+        return this.ttl > 0 && Date.now() - entry.loadedAt >= this.ttl;
+    }
+
+    // drops expired entries, then the least recently used ones over
+    // maxEntries (0: no limit); entries still loading are kept
+    prune() {
+        this.entries.forEach((entry, key) => {
+            if (!entry.loading && this.isExpired(entry)) this.entries.delete(key);
+        });
+
+        if (!this.maxEntries) return;
+
+        for (const [key, entry] of this.entries) {
+            if (this.entries.size <= this.maxEntries) break;
+            if (!entry.loading) this.entries.delete(key);
+        }
+    }
+
+    // null, or an ODBC search pattern (% and _), may stand for other names
+    static isPattern(arg) {
+        return arg === null || (typeof arg === 'string' && /[%_]/.test(arg));
+    }
+
+    // drops everything, or the entries that could include the given catalog,
+    // schema and table: those for the same names and those that matched them
+    // through a wildcard (null) or search pattern ('USER%') argument
+    invalidate({ catalog, schema, table } = {}) {
+        const filter = MetadataCache.normalize([catalog, schema, table]);
+
+        this.entries.forEach((entry, key) => {
+            const matches = filter.every((value, i) => MetadataCache.isPattern(value)
+                || MetadataCache.isPattern(entry.args[i]) || entry.args[i] === value);
+
+            if (matches) {
+                this.entries.delete(key);
+                this.counters.invalidations += 1;
+            }
+        });
+    }
+
+    // loads all tables and columns of a schema through db and caches the
+    // columns of each table as if columns(catalog, schema, table) had been
+    // called for it
+    async prefetch(db, catalog, schema) {
+        const tables = await this.get('tables', [catalog, schema, null, null], () => db.tables(catalog, schema, null, null, false));
+        const columns = await this.get('columns', [catalog, schema, null, null], () => db.columns(catalog, schema, null, null, false));
+
+        const byTable = new Map(tables.map(row => [row.TABLE_NAME, []]));
+
+        columns.forEach((row) => {
+            if (!byTable.has(row.TABLE_NAME)) byTable.set(row.TABLE_NAME, []);
+            byTable.get(row.TABLE_NAME).push(row);
+        });
+
+        byTable.forEach((rows, table) => this.set('columns', [catalog, schema, table, null], rows));
+
+        return { tables: tables.length, columns: columns.length };
+    }
+}
+
+module.exports = MetadataCache;
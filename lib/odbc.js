@@ -13,7 +13,10 @@
   OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 */
 
+const { ODBC } = require('./bindings');
 const Database = require('./database');
+const { Pool, RoutingPool } = require('./pool');
+const MetadataCache = require('./metadata_cache');
 
 async function open(connectionString, options) {
     const db = new Database(options);
@@ -21,7 +24,108 @@ async function open(connectionString, options) {
     return db;
 }
 
+// opens count connections in parallel, at most concurrency at a time (all of
+// them by default). Logins only wait on their own connection, so they run on
+// whatever threads the connections would use anyway: the libuv threadpool,
+// or the thread pool of the odbc environment or threadPoolSize given. If any
+// connection fails the ones already open are closed again.
+async function connectMany(connectionString, count, options = {}) {
+    const concurrency = Math.min(options.concurrency || count, count);
+    const odbc = options.odbc || new ODBC({
+        threadPoolSize: options.threadPoolSize,
+        globalLock: options.globalLock,
+        connectionPooling: options.connectionPooling,
+        poolMatch: options.poolMatch,
+        sharedEnvironment: options.sharedEnvironment,
+    });
+
+    const databases = [];
+    let remaining = count;
+    let failed = false;
+
+    const worker = async () => {
+        while (remaining > 0 && !failed) {
+            remaining -= 1;
+
+            const db = new Database({ ...options, odbc });
+
+            try {
+                await db.open(connectionString);
+            } catch (error) {
+                failed = true;
+                // frees the connection handle of the failed login
+                await db.close();
+                throw error;
+            }
+
+            databases.push(db);
+        }
+    };
+
+    const workers = [];
+
+    for (let i = 0; i < concurrency; i += 1) {
+        workers.push(worker());
+    }
+
+    const results = await Promise.all(workers.map(opened => opened.then(() => null, error => error)));
+    const error = results.find(result => result !== null);
+
+    if (error) {
+        await Promise.all(databases.map(db => db.close().catch(() => {})));
+        throw error;
+    }
+
+    return databases;
+}
+
+// the addon's process wide metrics (latency histograms per operation, rows
+// and bytes fetched, statement cache, statement pool and lock counters) plus
+// the stats of every open Pool
+function getMetrics() {
+    const metrics = ODBC.getMetrics();
+
+    metrics.pools = Array.from(Pool.open).map(open => ({
+        index: open.index,
+        connectionString: open.connectionString,
+        ...open.stats,
+    }));
+
+    return metrics;
+}
+
+// calls callback with getMetrics() every interval ms until the returned
+// function is called; doesn't keep the process alive
+function onMetrics(callback, interval = 10000) {
+    const timer = setInterval(() => callback(getMetrics()), interval);
+    if (timer.unref) timer.unref();
+
+    return () => clearInterval(timer);
+}
+
+// creates a Pool, or a RoutingPool when read replicas are given, and resolves
+// once its first min connections are open
+async function pool(options = {}) {
+    const created = options.replicas ? new RoutingPool(options) : new Pool(options);
+
+    try {
+        await created.init();
+    } catch (error) {
+        await created.close();
+        throw error;
+    }
+
+    return created;
+}
+
 module.exports = {
     open,
+    connectMany,
+    pool,
+    getMetrics,
+    onMetrics,
     Database,
+    Pool,
+    RoutingPool,
+    MetadataCache,
 };
@@ -1,149 +1,673 @@
+const { ODBC } = require('./bindings');
+const Database = require('./database');
+const MetadataCache = require('./metadata_cache');
+
+// A pool of open Databases sharing one ODBC environment. Released
+// connections are kept open and handed to the next caller instead of being
+// closed and opened again.
+//
+// Every new connection runs initSql and prepares cacheStatements before it
+// is handed out; init() opens the first min connections warmupConcurrency
+// at a time and resolves once they are all ready.
+//
+// Callers waiting for a connection are served strictly in the order they
+// called acquire(). Connections idle for longer than idleTimeout are closed
+// (down to min), and connections older than maxLifetime are replaced when
+// they are next released or found idle.
+//
+// With validateOnBorrow a connection is checked with isAlive() before it is
+// handed out, and with validationInterval idle connections are checked in
+// the background; dead ones are closed and replaced.
+//
+// Released connections are reset() in place (open transaction rolled back,
+// autocommit and session attributes restored) rather than closed and reopened; a
+// connection is only replaced when the reset fails or it is past maxLifetime.
 class Pool {
-  constructor(options) {
-    this.index = Pool.count++;
-    this.availablePool = {};
-    this.usedPool = {};
-    this.odbc = new odbc.ODBC();
+    constructor(options = {}) {
+        this.index = Pool.count++;
 
-    this.options = {
-      ...options,
-      odbc: this.odbc,
-    };
-  }
+        this.connectionString = options.connectionString;
+        this.min = options.min || 0;
+        this.max = options.max || 10;
+        this.acquireTimeout = options.acquireTimeout === undefined ? 30000 : options.acquireTimeout;
+        this.idleTimeout = options.idleTimeout === undefined ? 60000 : options.idleTimeout;
+        this.maxLifetime = options.maxLifetime || 0;
+        this.reapInterval = options.reapInterval || 1000;
+        this.warmupConcurrency = options.warmupConcurrency || 4;
+        this.validateOnBorrow = !!options.validateOnBorrow;
+        this.validationInterval = options.validationInterval || 0;
+        this.validationQuery = options.validationQuery;
+        this.resetOnRelease = options.resetOnRelease === undefined ? true : !!options.resetOnRelease;
 
-  open(connectionString) {
+        // run on, and prepared on, every connection the pool opens
+        this.initSql = [].concat(options.initSql || []);
+        this.cacheStatements = options.cacheStatements || [];
 
-  }
-}
+        this.odbc = options.odbc || new ODBC({
+            threadPoolSize: options.threadPoolSize,
+            globalLock: options.globalLock,
+            connectionPooling: options.connectionPooling,
+            poolMatch: options.poolMatch,
+            sharedEnvironment: options.sharedEnvironment,
+        });
 
-Pool.count = 0;
+        // tables() and columns() results shared by all of the pool's
+        // connections, with metadataCacheTtl (0: until invalidated) and at most
+        // metadataCacheMaxEntries entries
+        if (options.metadataCache instanceof MetadataCache) {
+            this.metadataCache = options.metadataCache;
+        } else if (options.metadataCache || options.metadataCacheTtl !== undefined) {
+            this.metadataCache = new MetadataCache({ ttl: options.metadataCacheTtl, maxEntries: options.metadataCacheMaxEntries });
+        }
 
-module.exports = {
-  Pool,
-};
+        // passed on to every Database the pool opens; the statement cache must
+        // be able to hold the statements prepared up front
+        this.options = {
+            ...options,
+            odbc: this.odbc,
+            metadataCache: this.metadataCache,
+            statementCacheSize: Math.max(options.statementCacheSize || 0, this.cacheStatements.length),
+        };
+
+        this.connections = new Map(); // Database -> { db, createdAt, lastUsed, lastValidated }
+        this.idle = [];               // most recently released last
+        this.borrowed = new Set();
+        this.waiting = [];            // oldest first
+        this.opening = 0;
+        this.validating = 0;
+        this.resetting = 0;
+        this.closed = false;
+
+        this.counters = {
+            created: 0,
+            destroyed: 0,
+            acquired: 0,
+            released: 0,
+            timeouts: 0,
+            evicted: 0,
+            expired: 0,
+            errors: 0,
+            validations: 0,
+            validationFailures: 0,
+            resets: 0,
+            resetFailures: 0,
+            waitTime: 0,
+            maxWaitTime: 0,
+        };
+
+        this.reaper = setInterval(() => this.reap(), this.reapInterval);
+        if (this.reaper.unref) this.reaper.unref();
+
+        Pool.open.add(this);
+    }
+
+    get size() {
+        return this.connections.size + this.opening;
+    }
+
+    get stats() {
+        return {
+            size: this.size,
+            idle: this.idle.length,
+            borrowed: this.borrowed.size,
+            opening: this.opening,
+            metadataCache: this.metadataCache ? this.metadataCache.stats : undefined,
+            validating: this.validating,
+            resetting: this.resetting,
+            waiting: this.waiting.length,
+            min: this.min,
+            max: this.max,
+            ...this.counters,
+        };
+    }
+
+    // opens min connections, at most warmupConcurrency at a time, and resolves
+    // once all of them are ready
+    async init() {
+        let missing = this.min - this.size;
+
+        const worker = async () => {
+            while (missing > 0 && !this.closed) {
+                missing -= 1;
+
+                try {
+                    await this.openConnection();
+                } catch (error) {
+                    this.counters.errors += 1;
+                    throw error;
+                }
+            }
+        };
+
+        const workers = [];
 
-Pool.prototype.open = function (connectionString, callback) {
-  var self = this
-    ,
-    db
-  ;
-
-  //check to see if we already have a connection for this connection string
-  if (self.availablePool[connectionString] && self.availablePool[connectionString].length) {
-    db = self.availablePool[connectionString].shift();
-    self.usedPool[connectionString].push(db);
-
-    callback(null, db);
-  } else {
-    db = new Database(self.options);
-    db.realClose = db.close;
-
-    db.close = function (cb) {
-      //call back early, we can do the rest of this stuff after the client thinks
-      //that the connection is closed.
-      cb(null);
-
-
-      //close the connection for real
-      //this will kill any temp tables or anything that might be a security issue.
-      db.realClose(function () {
-        //remove this db from the usedPool
-        self.usedPool[connectionString].splice(self.usedPool[connectionString].indexOf(db), 1);
-
-        //re-open the connection using the connection string
-        db.open(connectionString, function (error) {
-          if (error) {
-            console.error(error);
+        for (let i = 0; i < Math.min(this.warmupConcurrency, missing); i += 1) {
+            workers.push(worker());
+        }
+
+        await Promise.all(workers);
+
+        this.dispatch();
+
+        return this;
+    }
+
+    acquire() {
+        if (this.closed) {
+            return Promise.reject(new Error('[node-odbc] Pool is closed'));
+        }
+
+        return new Promise((resolve, reject) => {
+            const request = { resolve, reject, requestedAt: Date.now(), timer: null };
+
+            if (this.acquireTimeout > 0) {
+                request.timer = setTimeout(() => {
+                    const index = this.waiting.indexOf(request);
+
+                    // the request may be waiting on a connection being validated
+                    if (index !== -1) this.waiting.splice(index, 1);
+
+                    request.settled = true;
+                    this.counters.timeouts += 1;
+                    reject(new Error(`[node-odbc] Timed out after ${this.acquireTimeout}ms waiting for a pool connection`));
+                }, this.acquireTimeout);
+            }
+
+            this.waiting.push(request);
+            this.dispatch();
+        });
+    }
+
+    async release(db) {
+        const connection = this.connections.get(db);
+
+        if (!connection || !this.borrowed.has(db)) return;
+
+        this.borrowed.delete(db);
+        this.counters.released += 1;
+
+        if (this.closed || this.isExpired(connection)) {
+            if (!this.closed) this.counters.expired += 1;
+            await this.destroy(db);
+            this.dispatch();
             return;
-          }
+        }
 
-          //add this clean connection to the connection pool
-          self.availablePool[connectionString] = self.availablePool[connectionString] || [];
-          self.availablePool[connectionString].push(db);
-          exports.debug && console.dir(self);
+        if (this.resetOnRelease && !(await this.reset(connection))) {
+            await this.destroy(db);
+            this.fill().forEach(opened => opened.catch(() => {}));
+            this.dispatch();
+            return;
+        }
+
+        if (this.closed) {
+            await this.destroy(db);
+            return;
+        }
+
+        connection.lastUsed = Date.now();
+        this.idle.push(connection);
+        this.dispatch();
+    }
+
+    // resolves to whether the session could be put back to how it was opened
+    async reset(connection) {
+        let reset = false;
+
+        this.resetting += 1;
+        this.counters.resets += 1;
+
+        try {
+            await connection.db.reset();
+            reset = true;
+        } catch (e) {
+            this.counters.resetFailures += 1;
+        }
+
+        this.resetting -= 1;
+
+        return reset;
+    }
+
+    // closes a connection for good, whether it is idle or borrowed
+    async destroy(db) {
+        if (!this.connections.has(db)) return;
+
+        this.connections.delete(db);
+        this.borrowed.delete(db);
+        this.idle = this.idle.filter(connection => connection.db !== db);
+        this.counters.destroyed += 1;
+
+        try {
+            await Database.prototype.close.call(db);
+        } catch (e) {
+        }
+    }
+
+    async close(callback) {
+        this.closed = true;
+        clearInterval(this.reaper);
+        Pool.open.delete(this);
+
+        const waiting = this.waiting;
+        this.waiting = [];
+
+        waiting.forEach((request) => {
+            clearTimeout(request.timer);
+            request.settled = true;
+            request.reject(new Error('[node-odbc] Pool is closed'));
         });
-      });
-    };
 
-    db.open(connectionString, function (error) {
-      exports.debug && console.log('odbc.js : pool[%s] : pool.db.open callback()', self.index);
+        // borrowed connections are closed when they are released
+        await Promise.all(this.idle.map(connection => this.destroy(connection.db)));
 
-      self.usedPool[connectionString] = self.usedPool[connectionString] || [];
-      self.usedPool[connectionString].push(db);
+        if (callback) callback();
+    }
 
-      callback(error, db);
-    });
-  }
-};
+    // drops cached tables() and columns() results, all of them or those for
+    // { catalog, schema, table }
+    invalidateMetadata(filter) {
+        if (this.metadataCache) this.metadataCache.invalidate(filter);
+    }
+
+    // caches all tables and columns of a schema with two catalog queries
+    async prefetchMetadata(catalog, schema) {
+        if (!this.metadataCache) {
+            throw new Error('[node-odbc] The pool was created without a metadataCache');
+        }
+
+        const db = await this.acquire();
+
+        try {
+            return await this.metadataCache.prefetch(db, catalog, schema);
+        } finally {
+            await db.close();
+        }
+    }
+
+    // runs one query on a pooled connection and gives it back; options are
+    // those of Database.queryAll() (timeout, signal, fetchMode)
+    async query(sql, params, options) {
+        const db = await this.acquire();
+
+        try {
+            return await db.queryAll(sql, params, options);
+        } finally {
+            await db.close();
+        }
+    }
+
+    // callback style acquire, kept for existing callers. All connections of a
+    // pool share one connection string; asking for another is an error rather
+    // than a connection to the wrong database
+    open(connectionString, callback) {
+        if (!this.connectionString) this.connectionString = connectionString;
+
+        if (connectionString && connectionString !== this.connectionString) {
+            process.nextTick(() => callback(new Error('[node-odbc] The pool is connected to another connection string')));
+            return;
+        }
+
+        this.acquire().then(db => callback(null, db), error => callback(error));
+    }
+
+    // hands idle connections to waiting callers, oldest caller first, and
+    // opens new connections for the rest while there is room
+    dispatch() {
+        while (this.waiting.length && this.idle.length) {
+            const connection = this.idle.pop();
+
+            if (this.isExpired(connection)) {
+                this.counters.expired += 1;
+                this.destroy(connection.db);
+                continue;
+            }
+
+            const request = this.waiting.shift();
+
+            if (this.validateOnBorrow) {
+                this.validateAndServe(request, connection);
+            } else {
+                this.serve(request, connection);
+            }
+        }
+
+        while (this.waiting.length > this.opening && this.size < this.max && !this.closed) {
+            this.openConnection().then(() => this.dispatch(), (error) => {
+                this.counters.errors += 1;
+
+                const request = this.waiting.shift();
+
+                if (request) {
+                    clearTimeout(request.timer);
+                    request.settled = true;
+                    request.reject(error);
+                }
+            });
+        }
+    }
+
+    serve(request, connection) {
+        const waited = Date.now() - request.requestedAt;
+
+        clearTimeout(request.timer);
+        request.settled = true;
+
+        this.borrowed.add(connection.db);
+        connection.lastUsed = Date.now();
+
+        this.counters.acquired += 1;
+        this.counters.waitTime += waited;
+        this.counters.maxWaitTime = Math.max(this.counters.maxWaitTime, waited);
+
+        request.resolve(connection.db);
+    }
+
+    // opens one connection and adds it to the idle list
+    async openConnection() {
+        this.opening += 1;
+
+        const db = new Database(this.options);
+
+        try {
+            await db.open(this.connectionString);
 
-Pool.prototype.close = function (callback) {
-  var self = this
-    ,
-    required = 0
-    ,
-    received = 0
-    ,
-    connections
-    ,
-    key
-    ,
-    x
-  ;
+            try {
+                await this.prepareConnection(db);
+            } catch (error) {
+                await db.close();
+                throw error;
+            }
+        } finally {
+            this.opening -= 1;
+        }
+
+        // close() gives the connection back instead of closing it
+        db.close = () => this.release(db);
+
+        const now = Date.now();
+        const connection = { db, createdAt: now, lastUsed: now, lastValidated: now };
+
+        this.connections.set(db, connection);
+        this.counters.created += 1;
+
+        if (this.closed) {
+            await this.destroy(db);
+            return connection;
+        }
 
-  exports.debug && console.log('odbc.js : pool[%s] : pool.close()', self.index);
-  //we set a timeout because a previous db.close() may
-  //have caused the a behind the scenes db.open() to prepare
-  //a new connection
-  setTimeout(function () {
-    //merge the available pool and the usedPool
-    var pools = {};
+        this.idle.push(connection);
 
-    for (key in self.availablePool) {
-      pools[key] = (pools[key] || []).concat(self.availablePool[key]);
+        return connection;
     }
 
-    for (key in self.usedPool) {
-      pools[key] = (pools[key] || []).concat(self.usedPool[key]);
+    async prepareConnection(db) {
+        if (this.initSql.length) await db.batch(this.initSql);
+        if (this.cacheStatements.length) await db.cacheStatements(this.cacheStatements);
+    }
+
+    // resolves to whether the connection is still usable; a dead connection
+    // is closed
+    async validate(connection) {
+        let alive = false;
+
+        this.validating += 1;
+        this.counters.validations += 1;
+
+        try {
+            alive = await connection.db.isAlive(this.validationQuery);
+        } catch (e) {
+        }
+
+        this.validating -= 1;
+        connection.lastValidated = Date.now();
+
+        if (!alive) {
+            this.counters.validationFailures += 1;
+            await this.destroy(connection.db);
+        }
+
+        return alive;
     }
 
-    exports.debug && console.log('odbc.js : pool[%s] : pool.close() - setTimeout() callback', self.index);
-    exports.debug && console.dir(pools);
+    // checks a connection taken off the idle list for request before handing
+    // it over; if it is dead, request goes back to the head of the queue
+    async validateAndServe(request, connection) {
+        const alive = await this.validate(connection);
+
+        if (alive && this.closed) {
+            await this.destroy(connection.db);
+        } else if (alive && !request.settled) {
+            this.serve(request, connection);
+            return;
+        } else if (alive) {
+            // the caller gave up while we were checking
+            this.idle.push(connection);
+        }
+
+        if (request.settled) {
+            // nothing to do for this caller
+        } else if (this.closed) {
+            clearTimeout(request.timer);
+            request.settled = true;
+            request.reject(new Error('[node-odbc] Pool is closed'));
+        } else {
+            this.waiting.unshift(request);
+        }
 
-    if (Object.keys(pools).length == 0) {
-      return callback();
+        this.dispatch();
     }
 
-    for (key in pools) {
-      connections = pools[key];
-      required += connections.length;
+    // checks idle connections that haven't been validated for
+    // validationInterval; they are out of the idle list while being checked
+    validateIdle() {
+        const now = Date.now();
 
-      exports.debug && console.log('odbc.js : pool[%s] : pool.close() - processing pools %s - connections: %s', self.index, key, connections.length);
+        this.idle.slice().forEach((connection) => {
+            if (now - connection.lastValidated < this.validationInterval) return;
 
-      for (x = 0; x < connections.length; x++) {
-        (function (x) {
-          //call the realClose method to avoid
-          //automatically re-opening the connection
-          exports.debug && console.log('odbc.js : pool[%s] : pool.close() - calling realClose() for connection #%s', self.index, x);
+            this.idle.splice(this.idle.indexOf(connection), 1);
 
-          connections[x].realClose(function () {
-            exports.debug && console.log('odbc.js : pool[%s] : pool.close() - realClose() callback for connection #%s', self.index, x);
-            received += 1;
+            this.validate(connection).then((alive) => {
+                if (alive && this.closed) {
+                    this.destroy(connection.db);
+                } else if (alive) {
+                    // back at the cold end, it hasn't been used
+                    this.idle.unshift(connection);
+                    this.dispatch();
+                } else {
+                    this.fill().forEach(opened => opened.catch(() => {}));
+                    this.dispatch();
+                }
+            });
+        });
+    }
 
-            if (received === required) {
-              callback();
+    isExpired(connection) {
+        return this.maxLifetime > 0 && Date.now() - connection.createdAt >= this.maxLifetime;
+    }
 
-              //prevent mem leaks
-              self = null;
-              connections = null;
-              required = null;
-              received = null;
-              key = null;
+    // closes connections that have been idle too long, down to min, and those
+    // past their lifetime
+    reap() {
+        const now = Date.now();
 
-              return;
+        this.idle.slice().forEach((connection) => {
+            if (this.isExpired(connection)) {
+                this.counters.expired += 1;
+                this.destroy(connection.db);
+            } else if (this.idleTimeout > 0 && now - connection.lastUsed >= this.idleTimeout && this.size > this.min) {
+                this.counters.evicted += 1;
+                this.destroy(connection.db);
             }
-          });
-        })(x);
-      }
+        });
+
+        if (this.validationInterval > 0) this.validateIdle();
+
+        this.fill().forEach(opened => opened.catch(() => {}));
+    }
+
+    // opens connections until the pool holds min of them
+    fill() {
+        const missing = this.min - this.size;
+        const opened = [];
+
+        for (let i = 0; i < missing && !this.closed; i += 1) {
+            opened.push(this.openConnection().then(() => this.dispatch(), (error) => {
+                this.counters.errors += 1;
+                throw error;
+            }));
+        }
+
+        return opened;
     }
-  }, 2000);
+}
+
+Pool.count = 0;
+
+// pools that haven't been closed, for getMetrics()
+Pool.open = new Set();
+
+// A primary and its read replicas, each with a Pool of its own sharing one
+// ODBC environment. Work goes to the primary unless it is marked readOnly;
+// read only work goes to a replica picked by the routing policy:
+//
+//   - 'round-robin': each replica in turn
+//   - 'least-outstanding': the replica with the fewest borrowed connections
+//     plus callers waiting for one
+//   - 'latency': a random replica, weighted by the inverse of its recent
+//     average query time, so faster replicas get proportionally more work
+//
+// Replica connections are opened as read-only sessions (SQL_ATTR_ACCESS_MODE)
+// so a write sent to one by mistake fails on drivers that enforce it. With
+// no replicas, read only work goes to the primary.
+class RoutingPool {
+    constructor(options = {}) {
+        this.routing = options.routing || 'round-robin';
+
+        if (!RoutingPool.policies.includes(this.routing)) {
+            throw new Error(`[node-odbc] Unknown routing policy '${this.routing}', expected one of ${RoutingPool.policies.join(', ')}`);
+        }
+
+        const odbc = options.odbc || new ODBC({
+            threadPoolSize: options.threadPoolSize,
+            globalLock: options.globalLock,
+            connectionPooling: options.connectionPooling,
+            poolMatch: options.poolMatch,
+            sharedEnvironment: options.sharedEnvironment,
+        });
+
+        // one metadata cache for the primary and all replicas
+        let { metadataCache } = options;
+
+        if (!(metadataCache instanceof MetadataCache) && (metadataCache || options.metadataCacheTtl !== undefined)) {
+            metadataCache = new MetadataCache({ ttl: options.metadataCacheTtl, maxEntries: options.metadataCacheMaxEntries });
+        }
+
+        options = { ...options, metadataCache };
+
+        this.primary = new Pool({ ...options, odbc, readOnly: false });
+        this.replicas = (options.replicas || []).map(connectionString => new Pool({
+            ...options,
+            odbc,
+            connectionString,
+            readOnly: true,
+        }));
+
+        // recent average query time per replica in ms, null until measured
+        this.latency = new Map(this.replicas.map(replica => [replica, null]));
+        this.next = 0;
+    }
+
+    get stats() {
+        return {
+            routing: this.routing,
+            primary: this.primary.stats,
+            replicas: this.replicas.map(replica => ({
+                ...replica.stats,
+                connectionString: replica.connectionString,
+                latency: this.latency.get(replica),
+            })),
+        };
+    }
+
+    async init() {
+        await Promise.all([this.primary, ...this.replicas].map(pool => pool.init()));
+        return this;
+    }
+
+    // picks the pool the work should go to
+    route(readOnly) {
+        if (!readOnly || !this.replicas.length) return this.primary;
+
+        if (this.routing === 'least-outstanding') {
+            const load = replica => replica.borrowed.size + replica.waiting.length;
+
+            return this.replicas.reduce((best, replica) => (load(replica) < load(best) ? replica : best));
+        }
+
+        if (this.routing === 'latency') {
+            // unmeasured replicas count as the fastest one, so they get tried
+            const measured = this.replicas.map(replica => this.latency.get(replica)).filter(latency => latency !== null);
+            const fastest = measured.length ? Math.min(...measured) : 1;
+            const weights = this.replicas.map((replica) => {
+                const latency = this.latency.get(replica);
+                return 1 / Math.max(latency === null ? fastest : latency, 0.1);
+            });
+
+            let pick = Math.random() * weights.reduce((sum, weight) => sum + weight, 0);
+
+            for (let i = 0; i < this.replicas.length; i += 1) {
+                pick -= weights[i];
+                if (pick <= 0) return this.replicas[i];
+            }
+
+            return this.replicas[this.replicas.length - 1];
+        }
+
+        const replica = this.replicas[this.next % this.replicas.length];
+        this.next += 1;
+
+        return replica;
+    }
+
+    // the connection goes back to the pool it came from on close()
+    acquire(options = {}) {
+        return this.route(options.readOnly).acquire();
+    }
+
+    async query(sql, params, options) {
+        if (!Array.isArray(params) && params !== undefined) {
+            options = params;
+            params = undefined;
+        }
+
+        // readOnly picks the pool, the rest goes on to the query
+        const { readOnly, ...queryOptions } = options || {};
+        const pool = this.route(readOnly);
+        const start = Date.now();
+        const result = await pool.query(sql, params, queryOptions);
+
+        if (this.latency.has(pool)) {
+            const elapsed = Date.now() - start;
+            const average = this.latency.get(pool);
+
+            this.latency.set(pool, average === null ? elapsed : (average * 0.8) + (elapsed * 0.2));
+        }
+
+        return result;
+    }
+
+    async close(callback) {
+        await Promise.all([this.primary, ...this.replicas].map(pool => pool.close()));
+
+        if (callback) callback();
+    }
+}
+
+RoutingPool.policies = ['round-robin', 'least-outstanding', 'latency'];
+
+module.exports = {
+    Pool,
+    RoutingPool,
 };
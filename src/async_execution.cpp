@@ -0,0 +1,150 @@
+#include "async_execution.h"
+#include "deferred_async_worker.h"
+#include "statement_pool.h"
+#include "utils.h"
+#include "query_canceller.h"
+
+#define ASYNC_POLL_MIN_INTERVAL 1
+#define ASYNC_POLL_MAX_INTERVAL 50
+
+AsyncExecution::AsyncExecution(Napi::Env env, QueryData *data, Callback onComplete)
+  : env(env), data(data), onComplete(onComplete), interval(ASYNC_POLL_MIN_INTERVAL), aborted(false) {
+
+  uv_loop_t *loop;
+  napi_get_uv_event_loop(env, &loop);
+
+  uv_timer_init(loop, &this->timer);
+  this->timer.data = this;
+}
+
+// AsyncExecutionSetup, used by AsyncExecution::Start: gets the statement
+// ready on a worker thread, then starts polling from OnOK
+class AsyncExecutionSetup : public DeferredAsyncWorker {
+
+  public:
+    AsyncExecutionSetup(QueryData *data, Napi::Promise::Deferred deferred, AsyncExecution::Callback onComplete)
+    : DeferredAsyncWorker(deferred), data(data), onComplete(onComplete), refused(false) {}
+
+    ~AsyncExecutionSetup() {}
+
+    void Execute() {
+
+      DEBUG_PRINTF("AsyncExecutionSetup::Execute\n");
+
+      data->timings.started = uv_hrtime();
+
+      // a failure here is reported by the worker onComplete queues
+      data->sqlReturnCode = data->statementPool->Checkout(&(data->hSTMT));
+
+      if (!SQL_SUCCEEDED(data->sqlReturnCode)) {
+        return;
+      }
+
+      data->timings.allocated = uv_hrtime();
+
+      if (!SQL_SUCCEEDED(SQLSetStmtAttr(data->hSTMT, SQL_ATTR_ASYNC_ENABLE, (SQLPOINTER) SQL_ASYNC_ENABLE_ON, SQL_IS_UINTEGER))) {
+        refused = true;
+        return;
+      }
+
+      data->asyncExecution = true;
+
+      if (data->paramCount > 0) {
+        // binds all parameters to the query
+        BindParameters(data);
+      }
+
+      SetQueryTimeout(data);
+    }
+
+    void OnOK() {
+
+      if (refused) {
+        onComplete(data, false);
+        return;
+      }
+
+      // in flight until the worker onComplete queues is done (see
+      // DeferredAsyncWorker::Measure), this worker stops counting now
+      Metrics::InFlight(1);
+
+      if (!SQL_SUCCEEDED(data->sqlReturnCode)) {
+        onComplete(data, true);
+        return;
+      }
+
+      AsyncExecution *execution = new AsyncExecution(Env(), data, onComplete);
+
+      // a query aborted before it got here fails without running
+      execution->aborted = data->canceller && !data->canceller->Begin(data->hSTMT);
+
+      execution->Poll();
+    }
+
+  private:
+    QueryData               *data;
+    AsyncExecution::Callback onComplete;
+    bool                     refused;
+};
+
+void AsyncExecution::Start(QueryData *data, Napi::Promise::Deferred deferred, std::shared_ptr<Executor> executor, Callback onComplete) {
+
+  DEBUG_PRINTF("AsyncExecution::Start\n");
+
+  AsyncExecutionSetup *worker = new AsyncExecutionSetup(data, deferred, onComplete);
+  worker->Queue(executor);
+}
+
+void AsyncExecution::OnTimer(uv_timer_t *handle) {
+
+  AsyncExecution *execution = (AsyncExecution *) handle->data;
+  execution->Poll();
+}
+
+void AsyncExecution::OnClose(uv_handle_t *handle) {
+
+  delete (AsyncExecution *) handle->data;
+}
+
+void AsyncExecution::Poll() {
+
+  // with asynchronous execution on, calling the function again with the same
+  // arguments returns SQL_STILL_EXECUTING until the statement is done. After
+  // SQLCancel the next call returns SQL_ERROR.
+  SQLRETURN sqlReturnCode = SQL_ERROR;
+
+  if (!this->aborted) {
+    sqlReturnCode = SQLExecDirect(this->data->hSTMT, this->data->sql, SQL_NTS);
+  }
+
+  if (sqlReturnCode == SQL_STILL_EXECUTING) {
+    uv_timer_start(&this->timer, AsyncExecution::OnTimer, this->interval, 0);
+
+    if (this->interval < ASYNC_POLL_MAX_INTERVAL) {
+      this->interval = this->interval * 2 < ASYNC_POLL_MAX_INTERVAL ? this->interval * 2 : ASYNC_POLL_MAX_INTERVAL;
+    }
+    return;
+  }
+
+  DEBUG_PRINTF("AsyncExecution::Poll done : sqlReturnCode=%i\n", sqlReturnCode);
+
+  this->data->sqlReturnCode = sqlReturnCode;
+  this->data->timings.executed = uv_hrtime();
+
+  if (this->data->canceller) {
+    this->data->canceller->End();
+  }
+
+  // fetching is synchronous. After an error the diagnostics must survive until
+  // they are reported, so ReleaseStatement turns asynchronous mode off instead
+  if (SQL_SUCCEEDED(sqlReturnCode)) {
+    SQLSetStmtAttr(this->data->hSTMT, SQL_ATTR_ASYNC_ENABLE, (SQLPOINTER) SQL_ASYNC_ENABLE_OFF, SQL_IS_UINTEGER);
+    this->data->asyncExecution = false;
+  }
+
+  Napi::HandleScope scope(this->env);
+
+  this->onComplete(this->data, true);
+
+  uv_close((uv_handle_t *) &this->timer, AsyncExecution::OnClose);
+}
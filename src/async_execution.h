@@ -0,0 +1,62 @@
+#ifndef _SRC_ASYNC_EXECUTION_H
+#define _SRC_ASYNC_EXECUTION_H
+
+#include <functional>
+#include <memory>
+
+#include "declarations.h"
+
+class Executor;
+
+/*
+ * AsyncExecution
+ *
+ *   Runs SQLExecDirect with SQL_ATTR_ASYNC_ENABLE turned on and polls it from
+ *   the main thread on a uv_timer until it stops returning SQL_STILL_EXECUTING.
+ *   While the server works on a long statement no thread pool thread is held;
+ *   each poll is a short, non-blocking call into the driver. The poll interval
+ *   starts at 1ms and doubles up to 50ms.
+ *
+ *   Everything before the first poll that can block (checking a handle out
+ *   of the statement pool, setting its attributes, binding parameters) runs
+ *   as a short step on a worker thread first, so only the polling itself
+ *   happens on the main thread.
+ *
+ *   Once the statement is done, asynchronous mode is turned off again and the
+ *   callback gets the QueryData with sqlReturnCode set, so the rest of the
+ *   work (binding columns, fetching) can go to an AsyncWorker as usual. The
+ *   query counts in Metrics::InFlight from then until that worker is done.
+ *
+ *   Must be started on the main thread. Deletes itself when done.
+ */
+class AsyncExecution {
+
+  public:
+    // called on the main thread. async is false, and the statement hasn't
+    // run, if the driver refuses to run it asynchronously; the caller should
+    // then use the blocking path on the handle that is already checked out
+    typedef std::function<void(QueryData *data, bool async)> Callback;
+
+    // queues the setup step on executor (the libuv threadpool when there is
+    // none); deferred is the query's, it is only settled by the caller
+    static void Start(QueryData *data, Napi::Promise::Deferred deferred, std::shared_ptr<Executor> executor, Callback onComplete);
+
+  private:
+    friend class AsyncExecutionSetup;
+
+    AsyncExecution(Napi::Env env, QueryData *data, Callback onComplete);
+
+    static void OnTimer(uv_timer_t *handle);
+    static void OnClose(uv_handle_t *handle);
+
+    void Poll();
+
+    Napi::Env   env;
+    QueryData  *data;
+    Callback    onComplete;
+    uv_timer_t  timer;
+    uint64_t    interval;
+    bool        aborted;
+};
+
+#endif
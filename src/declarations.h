@@ -2,6 +2,7 @@
 #define _SRC_DECLARATIONS_H
 
 #include <napi.h>
+#include <memory>
 #include <wchar.h>
 #include <stdlib.h>
 #include <uv.h>
@@ -17,6 +18,9 @@
 
 #define MAX_FIELD_SIZE 1024
 #define MAX_VALUE_SIZE 1048576
+// the largest binary parameter bound as SQL_VARBINARY (SQL Server's limit);
+// longer ones are bound as SQL_LONGVARBINARY
+#define MAX_VARBINARY_SIZE 8000
 
 #ifdef UNICODE
 #define ERROR_MESSAGE_BUFFER_BYTES 2048
@@ -43,6 +47,13 @@ typedef struct Column {
   SQLLEN        dataLength;
 } Column;
 
+class ParameterStream;
+class StatementCache;
+class StatementPool;
+class QueryCanceller;
+class Executor;
+class HandleLock;
+
 typedef struct Parameter {
   SQLSMALLINT  InputOutputType;
   SQLSMALLINT  ValueType;
@@ -52,16 +63,82 @@ typedef struct Parameter {
   void        *ParameterValuePtr;
   SQLLEN       BufferLength;
   SQLLEN       StrLen_or_IndPtr;
+  ParameterStream       *stream;    // set for data-at-execution parameters
+  Napi::ObjectReference *reference; // keeps binary values bound in place alive
 } Parameter;
 
+// frees the values owned by the parameters and the array itself (utils.cpp)
+void FreeParameters(Parameter *params, int paramCount);
+
+// a diagnostic record copied out of the driver on a worker thread, so that it
+// can be turned into an error object later (see CaptureSQLError in utils.cpp)
+typedef struct DiagnosticRecord {
+  SQLTCHAR state[SQL_SQLSTATE_SIZE + 1];
+  SQLTCHAR message[ERROR_MESSAGE_BUFFER_CHARS];
+} DiagnosticRecord;
+
 typedef struct ColumnData {
   SQLTCHAR *data;
   int      size;
 } ColumnData;
 
+// what the driver told SQLGetInfo about itself right after login; strings are
+// empty and numbers 0 for anything it wouldn't say
+typedef struct Capabilities {
+  SQLTCHAR     driverName[256];
+  SQLTCHAR     driverVersion[64];
+  SQLTCHAR     driverOdbcVersion[16];
+  SQLTCHAR     dbmsName[256];
+  SQLTCHAR     dbmsVersion[64];
+  SQLTCHAR     identifierQuoteChar[8];
+  SQLUSMALLINT maxConcurrentActivities; // 0: no limit or unknown
+  SQLUSMALLINT maxIdentifierLength;
+  SQLUSMALLINT txnCapable;
+  SQLUINTEGER  scrollOptions;           // SQL_SO_* bits
+  SQLUINTEGER  asyncMode;               // SQL_AM_*
+  SQLUINTEGER  paramArrayRowCounts;     // SQL_PARC_*
+  SQLUINTEGER  paramArraySelects;       // SQL_PAS_*
+  SQLUINTEGER  getDataExtensions;       // SQL_GD_* bits
+} Capabilities;
+
+// uv_hrtime() stamps, in nanoseconds, of the steps a query went through; 0
+// for steps it didn't (see GetQueryTimings in utils.cpp)
+typedef struct QueryTimings {
+  uint64_t queued;       // the worker was queued on the main thread
+  uint64_t started;      // a thread picked it up
+  uint64_t allocated;    // a statement handle was ready
+  uint64_t executed;     // SQLExecute / SQLExecDirect returned
+  uint64_t bound;        // the result columns were bound
+  uint64_t fetchQueued;  // fetchAll() on the result was queued
+  uint64_t fetchStarted; // ... and picked up by a thread
+  uint64_t fetched;      // the rows were copied out of the driver
+  uint64_t materialized; // the rows were turned into JavaScript values
+} QueryTimings;
+
 typedef struct QueryData {
 
-  HSTMT hSTMT;
+  HSTMT hSTMT = SQL_NULL_HSTMT;
+
+  // set when hSTMT was taken from the connection's prepared statement cache
+  std::shared_ptr<StatementCache> statementCache;
+
+  // set when hSTMT was checked out of the connection's statement pool
+  std::shared_ptr<StatementPool> statementPool;
+
+  // SQL_ATTR_ASYNC_ENABLE is still on for hSTMT (see AsyncExecution)
+  bool asyncExecution = false;
+
+  // per-query options: SQL_ATTR_QUERY_TIMEOUT in seconds, and the canceller
+  // driven by an AbortSignal
+  SQLULEN queryTimeout = 0;
+  std::shared_ptr<QueryCanceller> canceller;
+
+  // the connection's dedicated thread, if it has one; work on the statement
+  // and its results is queued there
+  std::shared_ptr<Executor> executor;
+
+  // the connection's HandleLock, taken to free or close hSTMT
+  std::shared_ptr<HandleLock> connectionLock;
 
   int fetchMode;
   bool noResultObject = false;
@@ -92,24 +169,16 @@ typedef struct QueryData {
 
   SQLRETURN sqlReturnCode;
 
+  QueryTimings timings = QueryTimings();
+
   ~QueryData() {
 
+    // stop listening for an abort before the parameter streams it would
+    // cancel are freed
+    this->canceller.reset();
+
     if (this->paramCount) {
-      Parameter prm;
-      // free parameters
-      for (int i = 0; i < this->paramCount; i++) {
-        if (prm = this->params[i], prm.ParameterValuePtr != NULL) {
-          switch (prm.ValueType) {
-            case SQL_C_WCHAR:   free(prm.ParameterValuePtr);             break;
-            case SQL_C_CHAR:    free(prm.ParameterValuePtr);             break;
-            case SQL_C_LONG:    delete (int64_t *)prm.ParameterValuePtr; break;
-            case SQL_C_DOUBLE:  delete (double  *)prm.ParameterValuePtr; break;
-            case SQL_C_BIT:     delete (bool    *)prm.ParameterValuePtr; break;
-          }
-        }
-      }
-
-      free(this->params);
+      FreeParameters(this->params, this->paramCount);
     }
 
     delete columns;
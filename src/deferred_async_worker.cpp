@@ -1,10 +1,19 @@
 #include "deferred_async_worker.h"
+#include "executor.h"
 #include "utils.h"
 
 DeferredAsyncWorker::DeferredAsyncWorker(Napi::Promise::Deferred deferred)
-    : Napi::AsyncWorker(Napi::Function::New(Env(), EmptyCallback)), deferred(deferred) {}
+    : Napi::AsyncWorker(Napi::Function::New(Env(), EmptyCallback)), deferred(deferred),
+      operation(Metrics::NONE), queuedAt(0) {}
 
-DeferredAsyncWorker::~DeferredAsyncWorker() {}
+DeferredAsyncWorker::~DeferredAsyncWorker() {
+
+    // runs on the main thread once OnOK or OnError has been called
+    if (this->queuedAt != 0) {
+        Metrics::InFlight(-1);
+        Metrics::Record(this->operation, uv_hrtime() - this->queuedAt, !this->error.empty());
+    }
+}
 
 void DeferredAsyncWorker::OnOK() {
     Napi::Env env = Env();
@@ -20,6 +29,53 @@ void DeferredAsyncWorker::OnError(const Napi::Error &e) {
     Reject(e.Value());
 }
 
+void DeferredAsyncWorker::Measure(Metrics::Operation operation) {
+    this->operation = operation;
+}
+
+void DeferredAsyncWorker::Measure(Metrics::Operation operation, uint64_t began) {
+    this->operation = operation;
+    this->queuedAt = began;
+}
+
+void DeferredAsyncWorker::Queue(std::shared_ptr<Executor> executor) {
+
+    if (this->queuedAt == 0) {
+        this->queuedAt = uv_hrtime();
+        Metrics::InFlight(1);
+    }
+
+    if (!executor) {
+        Napi::AsyncWorker::Queue();
+        return;
+    }
+
+    // keeps the executor thread running until this worker has completed
+    this->executor = executor;
+    executor->Queue(this);
+}
+
+void DeferredAsyncWorker::Complete() {
+    Napi::Env env = Env();
+
+    {
+        Napi::HandleScope scope(env);
+
+        if (this->error.empty()) {
+            OnOK();
+        } else {
+            OnError(Napi::Error::New(env, this->error));
+        }
+    }
+
+    delete this;
+}
+
+void DeferredAsyncWorker::SetError(const std::string &error) {
+    this->error = error;
+    Napi::AsyncWorker::SetError(error);
+}
+
 void DeferredAsyncWorker::Resolve(napi_value value) {
     deferred.Resolve(value);
     Callback().Call({});
@@ -29,4 +85,3 @@ void DeferredAsyncWorker::Reject(napi_value value) {
     deferred.Reject(value);
     Callback().Call({});
 }
-
@@ -18,7 +18,13 @@
 #ifndef _SRC_DEFERRED_ASYNC_WORKER_H
 #define _SRC_DEFERRED_ASYNC_WORKER_H
 
+#include <memory>
+#include <string>
+
 #include "declarations.h"
+#include "metrics.h"
+
+class Executor;
 
 class DeferredAsyncWorker : public Napi::AsyncWorker {
 public:
@@ -32,11 +38,39 @@ public:
 
     virtual void OnError(const Napi::Error &e);
 
+    // queues on the connection's own thread when it has one, otherwise on the
+    // libuv threadpool
+    using Napi::AsyncWorker::Queue;
+    void Queue(std::shared_ptr<Executor> executor);
+
+    // called on the main thread by an Executor once Execute() has returned;
+    // calls OnOK or OnError and deletes the worker
+    void Complete();
+
   protected:
+    // the worker's time from Queue() until it is done is recorded under
+    // operation in Metrics
+    void Measure(Metrics::Operation operation);
+
+    // for the worker that finishes a query begun through AsyncExecution: the
+    // time since began is recorded instead, and the query already counts as
+    // in flight
+    void Measure(Metrics::Operation operation, uint64_t began);
+
     void Resolve(napi_value value);
     void Reject(napi_value value);
 
+    // remembers the error for Complete(), Napi::AsyncWorker keeps its own private
+    void SetError(const std::string &error);
+
     Napi::Promise::Deferred deferred;
+
+  private:
+    std::shared_ptr<Executor> executor;
+    std::string error;
+
+    Metrics::Operation operation;
+    uint64_t queuedAt;
 };
 
 #endif
@@ -0,0 +1,101 @@
+#include "environment.h"
+#include "odbc.h"
+
+std::map<Environment::Key, std::weak_ptr<Environment>> Environment::shared;
+
+Environment::Environment(bool globalLock, SQLUINTEGER poolMatch, bool setPoolMatch) {
+
+  DEBUG_PRINTF("Environment::Environment\n");
+
+  this->hEnv = NULL;
+  this->pooling = SQL_CP_OFF;
+  this->lock = globalLock ? ODBC::globalLock : std::make_shared<HandleLock>();
+
+  // ODBC::connectionPooling only changes under the global lock, so this is
+  // the mode the driver manager allocates the handle with
+  ODBC::globalLock->Lock();
+  this->sqlReturnCode = SQLAllocHandle(SQL_HANDLE_ENV, SQL_NULL_HANDLE, &this->hEnv);
+  this->pooling = ODBC::connectionPooling;
+  ODBC::globalLock->Unlock();
+
+  if (!SQL_SUCCEEDED(this->sqlReturnCode)) {
+    return;
+  }
+
+  // Use ODBC 3.x behavior
+  SQLSetEnvAttr(this->hEnv, SQL_ATTR_ODBC_VERSION, (SQLPOINTER) SQL_OV_ODBC3, SQL_IS_UINTEGER);
+
+  if (setPoolMatch) {
+    SQLSetEnvAttr(this->hEnv, SQL_ATTR_CP_MATCH, (SQLPOINTER)(uintptr_t) poolMatch, SQL_IS_UINTEGER);
+  }
+}
+
+Environment::~Environment() {
+
+  DEBUG_PRINTF("Environment::~Environment\n");
+
+  ODBC::globalLock->Lock();
+
+  if (this->hEnv) {
+    SQLFreeHandle(SQL_HANDLE_ENV, this->hEnv);
+    this->hEnv = NULL;
+  }
+
+  ODBC::globalLock->Unlock();
+}
+
+std::shared_ptr<Environment> Environment::Shared(napi_env owner, bool globalLock, SQLUINTEGER poolMatch, bool setPoolMatch) {
+
+  // an environment without an explicit poolMatch is a strict match one
+  SQLUINTEGER match = setPoolMatch ? poolMatch : SQL_CP_STRICT_MATCH;
+
+  ODBC::globalLock->Lock();
+
+  // an environment allocated before pooling was turned on (or under another
+  // pooling mode) isn't pooled, so only reuse one made under the current mode
+  Key key(owner, globalLock, match, ODBC::connectionPooling);
+
+  std::shared_ptr<Environment> environment = Environment::shared[key].lock();
+
+  // drop the entries of environments that are gone while we're here
+  for (auto it = Environment::shared.begin(); it != Environment::shared.end();) {
+    if (it->second.expired() && it->first != key) {
+      it = Environment::shared.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  ODBC::globalLock->Unlock();
+
+  if (environment) {
+    return environment;
+  }
+
+  // allocated outside the registry lock: the constructor takes it too
+  environment = std::make_shared<Environment>(globalLock, poolMatch, setPoolMatch);
+
+  if (!SQL_SUCCEEDED(environment->sqlReturnCode)) {
+    return environment;
+  }
+
+  ODBC::globalLock->Lock();
+
+  // pooling may have been changed by another thread in the meantime; file
+  // the environment under the mode it was actually allocated with
+  key = Key(owner, globalLock, match, environment->pooling);
+
+  // another thread may have got here first, in which case we use theirs
+  std::shared_ptr<Environment> existing = Environment::shared[key].lock();
+
+  if (existing) {
+    ODBC::globalLock->Unlock();
+    return existing;
+  }
+
+  Environment::shared[key] = environment;
+
+  ODBC::globalLock->Unlock();
+
+  return environment;
+}
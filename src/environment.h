@@ -0,0 +1,55 @@
+#ifndef _SRC_ENVIRONMENT_H
+#define _SRC_ENVIRONMENT_H
+
+#include <map>
+#include <memory>
+#include <tuple>
+
+#include "declarations.h"
+#include "handle_lock.h"
+
+/*
+ * Environment
+ *
+ *   An ODBC environment handle together with the lock that guards the
+ *   allocation and release of its connection handles. ODBC objects and the
+ *   connections created from them hold a reference, so the handle is only
+ *   freed once the last of them is gone, whichever goes first.
+ *
+ *   By default every ODBC object gets the process wide environment from
+ *   Shared(), so creating many short lived Databases doesn't set up a new
+ *   environment each time and environment level settings such as connection
+ *   pooling apply to all of them. Environments are only shared between ODBC
+ *   objects that would configure them the same way (globalLock, poolMatch)
+ *   and that were created under the same connection pooling mode, since
+ *   pooling only applies to environments allocated after it was turned on;
+ *   { sharedEnvironment: 'thread' } shares them only within one JavaScript
+ *   thread (worker_threads), { sharedEnvironment: false } not at all.
+ */
+class Environment {
+
+  public:
+    // allocates the handle and sets ODBC 3 behavior; check sqlReturnCode.
+    // With globalLock the connection handles are guarded by ODBC::globalLock
+    // instead of a lock of the environment's own
+    Environment(bool globalLock, SQLUINTEGER poolMatch, bool setPoolMatch);
+    ~Environment();
+
+    // the environment shared by every caller passing the same arguments,
+    // created when there is none; owner is NULL for the process wide one
+    static std::shared_ptr<Environment> Shared(napi_env owner, bool globalLock, SQLUINTEGER poolMatch, bool setPoolMatch);
+
+    SQLHENV                     hEnv;
+    SQLRETURN                   sqlReturnCode;
+    // ODBC::connectionPooling when the handle was allocated
+    SQLUINTEGER                 pooling;
+    std::shared_ptr<HandleLock> lock;
+
+  private:
+    typedef std::tuple<napi_env, bool, SQLUINTEGER, SQLUINTEGER> Key;
+
+    // guarded by ODBC::globalLock
+    static std::map<Key, std::weak_ptr<Environment>> shared;
+};
+
+#endif
@@ -0,0 +1,253 @@
+#include "executor.h"
+#include "deferred_async_worker.h"
+#include "metrics.h"
+
+Executor::Executor(Napi::Env env, unsigned int threadCount) {
+
+  this->env = env;
+  this->stopping = false;
+  this->next = 0;
+  this->outstanding = 0;
+  this->queued = 0;
+  this->running = 0;
+  this->peakQueued = 0;
+  this->executed = 0;
+  this->steals = 0;
+
+  uv_mutex_init(&this->mutex);
+  uv_cond_init(&this->cond);
+
+  uv_loop_t *loop;
+  napi_get_uv_event_loop(env, &loop);
+
+  // referenced only while workers are outstanding, an idle executor must not
+  // keep the process alive
+  this->async = new uv_async_t;
+  this->async->data = this;
+  uv_async_init(loop, this->async, Executor::OnComplete);
+  uv_unref((uv_handle_t *) this->async);
+
+  napi_async_init(env, Napi::Object::New(env), Napi::String::New(env, "ODBCExecutor"), &this->asyncContext);
+
+  if (threadCount == 0) {
+    threadCount = 1;
+  }
+
+  // all queues exist before any thread can try to steal from them
+  for (unsigned int i = 0; i < threadCount; i++) {
+    Thread *thread = new Thread;
+    thread->executor = this;
+    thread->index = i;
+    uv_mutex_init(&thread->mutex);
+    this->threads.push_back(thread);
+  }
+
+  for (unsigned int i = 0; i < threadCount; i++) {
+    uv_thread_create(&this->threads[i]->thread, Executor::Run, this->threads[i]);
+  }
+}
+
+Executor::~Executor() {
+
+  DEBUG_PRINTF("Executor::~Executor\n");
+
+  uv_mutex_lock(&this->mutex);
+  this->stopping = true;
+  uv_cond_broadcast(&this->cond);
+  uv_mutex_unlock(&this->mutex);
+
+  for (size_t i = 0; i < this->threads.size(); i++) {
+    uv_thread_join(&this->threads[i]->thread);
+  }
+
+  for (size_t i = 0; i < this->threads.size(); i++) {
+    uv_mutex_destroy(&this->threads[i]->mutex);
+    delete this->threads[i];
+  }
+
+  napi_async_destroy(this->env, this->asyncContext);
+
+  this->async->data = NULL;
+  uv_close((uv_handle_t *) this->async, Executor::CloseHandle);
+
+  uv_cond_destroy(&this->cond);
+  uv_mutex_destroy(&this->mutex);
+}
+
+void Executor::CloseHandle(uv_handle_t *handle) {
+  delete (uv_async_t *) handle;
+}
+
+/*
+ * Main thread
+ */
+
+void Executor::Queue(DeferredAsyncWorker *worker) {
+
+  if (this->outstanding++ == 0) {
+    uv_ref((uv_handle_t *) this->async);
+  }
+
+  // counted before any thread can take it off again
+  Metrics::ExecutorQueued(1);
+
+  Thread *thread = this->threads[this->next];
+  this->next = (this->next + 1) % this->threads.size();
+
+  // the worker is in a queue before it is counted, so a thread that reserves
+  // it is sure to find it
+  uv_mutex_lock(&thread->mutex);
+  thread->work.push_back(worker);
+  uv_mutex_unlock(&thread->mutex);
+
+  uv_mutex_lock(&this->mutex);
+  this->queued++;
+  if (this->queued > this->peakQueued) {
+    this->peakQueued = this->queued;
+  }
+  uv_cond_signal(&this->cond);
+  uv_mutex_unlock(&this->mutex);
+}
+
+Napi::Object Executor::Stats(Napi::Env env) {
+
+  uv_mutex_lock(&this->mutex);
+
+  Napi::Object stats = Napi::Object::New(env);
+  stats.Set("threads", Napi::Number::New(env, this->threads.size()));
+  stats.Set("queued", Napi::Number::New(env, this->queued));
+  stats.Set("running", Napi::Number::New(env, this->running));
+  stats.Set("peakQueued", Napi::Number::New(env, this->peakQueued));
+  stats.Set("executed", Napi::Number::New(env, this->executed));
+  stats.Set("steals", Napi::Number::New(env, this->steals));
+
+  uv_mutex_unlock(&this->mutex);
+
+  return stats;
+}
+
+void Executor::OnComplete(uv_async_t *handle) {
+
+  Executor *executor = (Executor *) handle->data;
+
+  if (executor == NULL) {
+    return;
+  }
+
+  // the last worker may hold the last reference to the executor
+  std::shared_ptr<Executor> self = executor->shared_from_this();
+
+  std::deque<DeferredAsyncWorker*> completed;
+
+  uv_mutex_lock(&executor->mutex);
+  completed.swap(executor->completed);
+  uv_mutex_unlock(&executor->mutex);
+
+  Napi::Env env = Napi::Env(executor->env);
+  Napi::HandleScope scope(env);
+
+  // resolve inside a callback scope so promise reactions run before we return
+  // to the event loop, as they do for napi_async_work
+  napi_callback_scope callbackScope;
+  napi_open_callback_scope(env, Napi::Object::New(env), executor->asyncContext, &callbackScope);
+
+  while (!completed.empty()) {
+    DeferredAsyncWorker *worker = completed.front();
+    completed.pop_front();
+
+    worker->Complete();
+    executor->outstanding--;
+
+    if (env.IsExceptionPending()) {
+      napi_fatal_exception(env, env.GetAndClearPendingException().Value());
+    }
+  }
+
+  napi_close_callback_scope(env, callbackScope);
+
+  if (executor->outstanding == 0) {
+    uv_unref((uv_handle_t *) executor->async);
+  }
+}
+
+/*
+ * Executor threads
+ */
+
+void Executor::Run(void *arg) {
+
+  Thread *thread = (Thread *) arg;
+  Executor *executor = thread->executor;
+
+  uv_mutex_lock(&executor->mutex);
+
+  while (true) {
+
+    while (!executor->stopping && executor->queued == 0) {
+      uv_cond_wait(&executor->cond, &executor->mutex);
+    }
+
+    if (executor->stopping) {
+      break;
+    }
+
+    // reserve one worker, then go and find it
+    executor->queued--;
+    executor->running++;
+
+    uv_mutex_unlock(&executor->mutex);
+
+    Metrics::ExecutorQueued(-1);
+
+    bool stolen = false;
+    DeferredAsyncWorker *worker = executor->Take(thread, &stolen);
+
+    worker->Execute();
+
+    uv_mutex_lock(&executor->mutex);
+
+    executor->running--;
+    executor->executed++;
+    if (stolen) {
+      executor->steals++;
+    }
+
+    executor->completed.push_back(worker);
+    uv_async_send(executor->async);
+  }
+
+  uv_mutex_unlock(&executor->mutex);
+}
+
+DeferredAsyncWorker* Executor::Take(Thread *thread, bool *stolen) {
+
+  size_t threadCount = this->threads.size();
+
+  while (true) {
+
+    // oldest first from our own queue
+    uv_mutex_lock(&thread->mutex);
+    if (!thread->work.empty()) {
+      DeferredAsyncWorker *worker = thread->work.front();
+      thread->work.pop_front();
+      uv_mutex_unlock(&thread->mutex);
+      return worker;
+    }
+    uv_mutex_unlock(&thread->mutex);
+
+    // newest first from everybody else's
+    for (size_t i = 1; i < threadCount; i++) {
+      Thread *victim = this->threads[(thread->index + i) % threadCount];
+
+      uv_mutex_lock(&victim->mutex);
+      if (!victim->work.empty()) {
+        DeferredAsyncWorker *worker = victim->work.back();
+        victim->work.pop_back();
+        uv_mutex_unlock(&victim->mutex);
+        *stolen = true;
+        return worker;
+      }
+      uv_mutex_unlock(&victim->mutex);
+    }
+  }
+}
@@ -0,0 +1,87 @@
+#ifndef _SRC_EXECUTOR_H
+#define _SRC_EXECUTOR_H
+
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "declarations.h"
+
+class DeferredAsyncWorker;
+
+/*
+ * Executor
+ *
+ *   A set of native threads that run DeferredAsyncWorkers instead of the
+ *   shared libuv threadpool, so database work never waits behind fs, crypto
+ *   or zlib work and its concurrency doesn't depend on UV_THREADPOOL_SIZE.
+ *   Two kinds are created:
+ *
+ *     - one thread owned by a single connection (createConnection with
+ *       dedicatedThread: true); the connection's work is serialized and always
+ *       runs on the same thread
+ *     - a pool shared by every connection of an ODBC environment (new ODBC
+ *       with threadPoolSize)
+ *
+ *   Each thread has its own queue; new work is spread over them round robin
+ *   and a thread whose queue is empty steals from the back of the others'.
+ *   Finished workers are handed back to the main thread through a uv_async_t,
+ *   which only keeps the event loop alive while work is outstanding.
+ *
+ *   Every queued worker holds a reference to the Executor, so the threads are
+ *   only stopped (and joined) once nothing is queued on them. Must be created
+ *   and destroyed on the main thread.
+ */
+class Executor : public std::enable_shared_from_this<Executor> {
+
+  public:
+    Executor(Napi::Env env, unsigned int threadCount);
+    ~Executor();
+
+    // main thread: runs worker->Execute() on one of the threads, then
+    // worker->Complete() back on the main thread
+    void Queue(DeferredAsyncWorker *worker);
+
+    Napi::Object Stats(Napi::Env env);
+
+  private:
+    typedef struct Thread {
+      Executor                         *executor;
+      unsigned int                      index;
+      uv_thread_t                       thread;
+      uv_mutex_t                        mutex;
+      std::deque<DeferredAsyncWorker*>  work;
+    } Thread;
+
+    static void Run(void *arg);
+    static void OnComplete(uv_async_t *handle);
+    static void CloseHandle(uv_handle_t *handle);
+
+    // takes a worker from thread's own queue, or steals one from another
+    // thread; only called after a worker has been reserved from queued
+    DeferredAsyncWorker* Take(Thread *thread, bool *stolen);
+
+    napi_env            env;
+    napi_async_context  asyncContext;
+    uv_async_t         *async;
+    uv_mutex_t          mutex;
+    uv_cond_t           cond;
+    bool                stopping;
+
+    std::vector<Thread*>             threads;
+    std::deque<DeferredAsyncWorker*> completed;
+
+    // main thread only: the next thread to queue on, and the number of
+    // workers queued and not yet completed
+    unsigned int next;
+    unsigned int outstanding;
+
+    // guarded by mutex
+    uint64_t queued;
+    uint64_t running;
+    uint64_t peakQueued;
+    uint64_t executed;
+    uint64_t steals;
+};
+
+#endif
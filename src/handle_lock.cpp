@@ -0,0 +1,64 @@
+#include "handle_lock.h"
+#include "metrics.h"
+
+HandleLock::HandleLock()
+  : acquisitions(0), contended(0), waitTime(0), maxWaitTime(0) {
+
+  uv_mutex_init(&this->mutex);
+  uv_mutex_init(&this->statsMutex);
+}
+
+HandleLock::~HandleLock() {
+
+  uv_mutex_destroy(&this->statsMutex);
+  uv_mutex_destroy(&this->mutex);
+}
+
+void HandleLock::Lock() {
+
+  uint64_t waited = 0;
+  bool wasContended = false;
+
+  // only time the lock when somebody else has it
+  if (uv_mutex_trylock(&this->mutex) != 0) {
+    uint64_t start = uv_hrtime();
+    uv_mutex_lock(&this->mutex);
+    waited = uv_hrtime() - start;
+    wasContended = true;
+
+    Metrics::LockWaited(waited);
+  }
+
+  uv_mutex_lock(&this->statsMutex);
+
+  this->acquisitions++;
+
+  if (wasContended) {
+    this->contended++;
+    this->waitTime += waited;
+    if (waited > this->maxWaitTime) {
+      this->maxWaitTime = waited;
+    }
+  }
+
+  uv_mutex_unlock(&this->statsMutex);
+}
+
+void HandleLock::Unlock() {
+  uv_mutex_unlock(&this->mutex);
+}
+
+Napi::Object HandleLock::Stats(Napi::Env env) {
+
+  uv_mutex_lock(&this->statsMutex);
+
+  Napi::Object stats = Napi::Object::New(env);
+  stats.Set(Napi::String::New(env, "acquisitions"), Napi::Number::New(env, this->acquisitions));
+  stats.Set(Napi::String::New(env, "contended"), Napi::Number::New(env, this->contended));
+  stats.Set(Napi::String::New(env, "waitTime"), Napi::Number::New(env, this->waitTime / 1e6));
+  stats.Set(Napi::String::New(env, "maxWaitTime"), Napi::Number::New(env, this->maxWaitTime / 1e6));
+
+  uv_mutex_unlock(&this->statsMutex);
+
+  return stats;
+}
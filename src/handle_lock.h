@@ -0,0 +1,44 @@
+#ifndef _SRC_HANDLE_LOCK_H
+#define _SRC_HANDLE_LOCK_H
+
+#include "declarations.h"
+
+/*
+ * HandleLock
+ *
+ *   Serializes the ODBC calls that allocate, free or reconfigure handles.
+ *   Every environment has one for its connection handles, and every
+ *   connection one for its statement handles, login and attributes, so a
+ *   slow login only holds up work on its own connection.
+ *
+ *   Drivers that aren't thread safe can be run the old way: an environment
+ *   created with { globalLock: true } uses ODBC::globalLock for itself and
+ *   for all of its connections.
+ *
+ *   Counts acquisitions and the time spent waiting for the lock, so contention
+ *   shows up in Stats() (acquisitions, contended, and waitTime / maxWaitTime
+ *   in milliseconds). Lock and Unlock may be called from any thread.
+ */
+class HandleLock {
+
+  public:
+    HandleLock();
+    ~HandleLock();
+
+    void Lock();
+    void Unlock();
+
+    Napi::Object Stats(Napi::Env env);
+
+  private:
+    uv_mutex_t mutex;
+
+    // the counters are kept apart so Stats never waits behind a long login
+    uv_mutex_t statsMutex;
+    uint64_t   acquisitions;
+    uint64_t   contended;
+    uint64_t   waitTime;    // nanoseconds
+    uint64_t   maxWaitTime; // nanoseconds
+};
+
+#endif
@@ -0,0 +1,271 @@
+#include "metrics.h"
+
+static const char *OPERATION_NAMES[] = { "open", "query", "execute", "fetch", "close" };
+
+std::vector<Metrics::Shard*> Metrics::shards;
+Metrics::Shard               Metrics::retired;
+std::atomic<int64_t>         Metrics::inFlight(0);
+std::atomic<int64_t>         Metrics::executorQueued(0);
+
+// registers the shard of the thread it belongs to, and folds it into the
+// retired totals when the thread exits
+class Metrics::ThreadShard {
+
+  public:
+    ThreadShard() {
+      this->shard = new Shard();
+
+      uv_mutex_lock(Metrics::Mutex());
+      Metrics::shards.push_back(this->shard);
+      uv_mutex_unlock(Metrics::Mutex());
+    }
+
+    ~ThreadShard() {
+      uv_mutex_lock(Metrics::Mutex());
+
+      Metrics::Merge(&Metrics::retired, this->shard);
+
+      for (size_t i = 0; i < Metrics::shards.size(); i++) {
+        if (Metrics::shards[i] == this->shard) {
+          Metrics::shards.erase(Metrics::shards.begin() + i);
+          break;
+        }
+      }
+
+      uv_mutex_unlock(Metrics::Mutex());
+
+      delete this->shard;
+    }
+
+    Shard *shard;
+};
+
+uv_mutex_t* Metrics::Mutex() {
+
+  static struct RegistryMutex {
+    RegistryMutex() { uv_mutex_init(&this->mutex); }
+    uv_mutex_t mutex;
+  } registryMutex;
+
+  return &registryMutex.mutex;
+}
+
+Metrics::Shard* Metrics::Local() {
+
+  static thread_local ThreadShard local;
+
+  return local.shard;
+}
+
+// only the owning thread writes a shard, so there is nothing to compare and
+// swap, the atomic is there for Snapshot() reading it from another thread
+void Metrics::Add(std::atomic<uint64_t> *counter, uint64_t value) {
+  counter->store(counter->load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+void Metrics::Merge(Shard *into, Shard *from) {
+
+  for (int operation = 0; operation < OPERATION_COUNT; operation++) {
+    Histogram *to = &(into->histograms[operation]);
+    Histogram *histogram = &(from->histograms[operation]);
+
+    for (int i = 0; i < BUCKETS; i++) {
+      Add(&(to->buckets[i]), histogram->buckets[i].load(std::memory_order_relaxed));
+    }
+
+    Add(&(to->count), histogram->count.load(std::memory_order_relaxed));
+    Add(&(to->failed), histogram->failed.load(std::memory_order_relaxed));
+    Add(&(to->sum), histogram->sum.load(std::memory_order_relaxed));
+
+    uint64_t max = histogram->max.load(std::memory_order_relaxed);
+    if (max > to->max.load(std::memory_order_relaxed)) {
+      to->max.store(max, std::memory_order_relaxed);
+    }
+  }
+
+  Add(&(into->rows), from->rows.load(std::memory_order_relaxed));
+  Add(&(into->bytes), from->bytes.load(std::memory_order_relaxed));
+  Add(&(into->lockWaits), from->lockWaits.load(std::memory_order_relaxed));
+  Add(&(into->lockWaitTime), from->lockWaitTime.load(std::memory_order_relaxed));
+  Add(&(into->cacheHits), from->cacheHits.load(std::memory_order_relaxed));
+  Add(&(into->cacheMisses), from->cacheMisses.load(std::memory_order_relaxed));
+  Add(&(into->poolReuses), from->poolReuses.load(std::memory_order_relaxed));
+  Add(&(into->poolAllocations), from->poolAllocations.load(std::memory_order_relaxed));
+}
+
+// values below SUB_BUCKETS get a bucket each; above that every power of two
+// is split into SUB_BUCKETS linear buckets
+int Metrics::BucketIndex(uint64_t microseconds) {
+
+  if (microseconds < (uint64_t) SUB_BUCKETS) {
+    return (int) microseconds;
+  }
+
+  int exponent = 63;
+  while (!(microseconds & ((uint64_t) 1 << exponent))) {
+    exponent--;
+  }
+
+  int shift = exponent - SUB_BUCKET_BITS;
+  int index = (shift + 1) * SUB_BUCKETS + (int) ((microseconds >> shift) - SUB_BUCKETS);
+
+  return index < BUCKETS ? index : BUCKETS - 1;
+}
+
+// the highest value that falls into the bucket
+uint64_t Metrics::BucketValue(int index) {
+
+  if (index < SUB_BUCKETS) {
+    return (uint64_t) index;
+  }
+
+  int shift = index / SUB_BUCKETS - 1;
+  uint64_t subBucket = (uint64_t) (index % SUB_BUCKETS + SUB_BUCKETS);
+
+  return ((subBucket + 1) << shift) - 1;
+}
+
+void Metrics::Record(Operation operation, uint64_t nanoseconds, bool failed) {
+
+  if (operation < 0 || operation >= OPERATION_COUNT) {
+    return;
+  }
+
+  Histogram *histogram = &(Local()->histograms[operation]);
+  uint64_t microseconds = nanoseconds / 1000;
+
+  Add(&(histogram->buckets[BucketIndex(microseconds)]), 1);
+  Add(&(histogram->count), 1);
+  Add(&(histogram->sum), microseconds);
+
+  if (failed) {
+    Add(&(histogram->failed), 1);
+  }
+
+  if (microseconds > histogram->max.load(std::memory_order_relaxed)) {
+    histogram->max.store(microseconds, std::memory_order_relaxed);
+  }
+}
+
+void Metrics::Fetched(uint64_t rows, uint64_t bytes) {
+
+  Shard *shard = Local();
+
+  Add(&(shard->rows), rows);
+  Add(&(shard->bytes), bytes);
+}
+
+void Metrics::LockWaited(uint64_t nanoseconds) {
+
+  Shard *shard = Local();
+
+  Add(&(shard->lockWaits), 1);
+  Add(&(shard->lockWaitTime), nanoseconds);
+}
+
+void Metrics::StatementCacheLookup(bool hit) {
+  Add(hit ? &(Local()->cacheHits) : &(Local()->cacheMisses), 1);
+}
+
+void Metrics::StatementPoolCheckout(bool reused) {
+  Add(reused ? &(Local()->poolReuses) : &(Local()->poolAllocations), 1);
+}
+
+void Metrics::InFlight(int delta) {
+  Metrics::inFlight += delta;
+}
+
+void Metrics::ExecutorQueued(int delta) {
+  Metrics::executorQueued += delta;
+}
+
+/*
+ *  Metrics::Snapshot
+ *
+ *    Description: Merges the shards of all threads into one set of totals.
+ *
+ *    Return:
+ *      Napi::Object:
+ *        { operations: { open, query, execute, fetch, close }, inFlight,
+ *          executorQueued, rows, bytes, statementCache: { hits, misses },
+ *          statementPool: { reuses, allocations },
+ *          locks: { waits, waitTime } }, where every operation has count,
+ *          failed, and mean, max, p50, p90, p99 and p999 in milliseconds.
+ */
+Napi::Object Metrics::Snapshot(Napi::Env env) {
+
+  Shard *total = new Shard();
+
+  uv_mutex_lock(Metrics::Mutex());
+
+  Merge(total, &Metrics::retired);
+
+  for (size_t i = 0; i < Metrics::shards.size(); i++) {
+    Merge(total, Metrics::shards[i]);
+  }
+
+  uv_mutex_unlock(Metrics::Mutex());
+
+  Napi::Object snapshot = Napi::Object::New(env);
+  Napi::Object operations = Napi::Object::New(env);
+
+  const double percentiles[] = { 0.5, 0.9, 0.99, 0.999 };
+  const char *percentileNames[] = { "p50", "p90", "p99", "p999" };
+
+  for (int operation = 0; operation < OPERATION_COUNT; operation++) {
+    Histogram *histogram = &(total->histograms[operation]);
+    uint64_t count = histogram->count.load();
+    uint64_t max = histogram->max.load();
+
+    Napi::Object stats = Napi::Object::New(env);
+    stats.Set("count", Napi::Number::New(env, count));
+    stats.Set("failed", Napi::Number::New(env, histogram->failed.load()));
+    stats.Set("mean", Napi::Number::New(env, count ? histogram->sum.load() / (double) count / 1000 : 0));
+    stats.Set("max", Napi::Number::New(env, max / 1000.0));
+
+    uint64_t seen = 0;
+    int bucket = 0;
+
+    for (int p = 0; p < 4; p++) {
+      uint64_t rank = (uint64_t) (percentiles[p] * count + 0.5);
+      if (rank == 0) {
+        rank = 1;
+      }
+
+      while (bucket < BUCKETS && seen + histogram->buckets[bucket].load() < rank) {
+        seen += histogram->buckets[bucket].load();
+        bucket++;
+      }
+
+      uint64_t value = count && bucket < BUCKETS ? BucketValue(bucket) : 0;
+      stats.Set(percentileNames[p], Napi::Number::New(env, (value < max ? value : max) / 1000.0));
+    }
+
+    operations.Set(OPERATION_NAMES[operation], stats);
+  }
+
+  snapshot.Set("operations", operations);
+  snapshot.Set("inFlight", Napi::Number::New(env, (double) Metrics::inFlight.load()));
+  snapshot.Set("executorQueued", Napi::Number::New(env, (double) Metrics::executorQueued.load()));
+  snapshot.Set("rows", Napi::Number::New(env, total->rows.load()));
+  snapshot.Set("bytes", Napi::Number::New(env, total->bytes.load()));
+
+  Napi::Object statementCache = Napi::Object::New(env);
+  statementCache.Set("hits", Napi::Number::New(env, total->cacheHits.load()));
+  statementCache.Set("misses", Napi::Number::New(env, total->cacheMisses.load()));
+  snapshot.Set("statementCache", statementCache);
+
+  Napi::Object statementPool = Napi::Object::New(env);
+  statementPool.Set("reuses", Napi::Number::New(env, total->poolReuses.load()));
+  statementPool.Set("allocations", Napi::Number::New(env, total->poolAllocations.load()));
+  snapshot.Set("statementPool", statementPool);
+
+  Napi::Object locks = Napi::Object::New(env);
+  locks.Set("waits", Napi::Number::New(env, total->lockWaits.load()));
+  locks.Set("waitTime", Napi::Number::New(env, total->lockWaitTime.load() / 1e6));
+  snapshot.Set("locks", locks);
+
+  delete total;
+
+  return snapshot;
+}
@@ -0,0 +1,98 @@
+#ifndef _SRC_METRICS_H
+#define _SRC_METRICS_H
+
+#include <atomic>
+#include <vector>
+
+#include "declarations.h"
+
+/*
+ * Metrics
+ *
+ *   Process wide counters for everything the addon does: a latency histogram
+ *   per kind of operation, rows and bytes fetched, statement cache and
+ *   statement pool hit rates, time spent waiting for HandleLocks, and the
+ *   number of operations in flight and waiting for an Executor thread.
+ *
+ *   Cheap enough to leave on: every thread (worker threads and the main
+ *   thread alike) records into a shard of its own, without locks, and the
+ *   shards are only merged when Snapshot() is read. A thread that exits
+ *   folds its shard into the totals first.
+ *
+ *   Histograms are log-linear, like HDR histograms: microsecond values are
+ *   kept exactly up to 16us and within 1/16 (about 6%) above that.
+ */
+class Metrics {
+
+  public:
+    enum Operation {
+      NONE = -1,
+      OPEN = 0,
+      QUERY,
+      EXECUTE,
+      FETCH,
+      CLOSE,
+      OPERATION_COUNT
+    };
+
+    // any thread
+    static void Record(Operation operation, uint64_t nanoseconds, bool failed);
+    static void Fetched(uint64_t rows, uint64_t bytes);
+    static void LockWaited(uint64_t nanoseconds);
+    static void StatementCacheLookup(bool hit);
+    static void StatementPoolCheckout(bool reused);
+
+    // operations queued and not yet completed, and those waiting for an
+    // Executor thread (work on the libuv threadpool can't be seen waiting)
+    static void InFlight(int delta);
+    static void ExecutorQueued(int delta);
+
+    // main thread
+    static Napi::Object Snapshot(Napi::Env env);
+
+  private:
+    static const int SUB_BUCKET_BITS = 4;
+    static const int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static const int BUCKETS = SUB_BUCKETS * 38; // up to 2^41us, about 25 days
+
+    typedef struct Histogram {
+      std::atomic<uint64_t> buckets[BUCKETS];
+      std::atomic<uint64_t> count;
+      std::atomic<uint64_t> failed;
+      std::atomic<uint64_t> sum; // microseconds
+      std::atomic<uint64_t> max; // microseconds
+    } Histogram;
+
+    // written only by the thread that owns it, read by Snapshot()
+    typedef struct Shard {
+      Histogram             histograms[OPERATION_COUNT];
+      std::atomic<uint64_t> rows;
+      std::atomic<uint64_t> bytes;
+      std::atomic<uint64_t> lockWaits;
+      std::atomic<uint64_t> lockWaitTime; // nanoseconds
+      std::atomic<uint64_t> cacheHits;
+      std::atomic<uint64_t> cacheMisses;
+      std::atomic<uint64_t> poolReuses;
+      std::atomic<uint64_t> poolAllocations;
+    } Shard;
+
+    class ThreadShard;
+
+    static Shard* Local();
+    static void Add(std::atomic<uint64_t> *counter, uint64_t value);
+    static void Merge(Shard *into, Shard *from);
+    static int BucketIndex(uint64_t microseconds);
+    static uint64_t BucketValue(int index);
+
+    // guards shards and retired
+    static uv_mutex_t* Mutex();
+
+    // shards of live threads, and what exited threads left behind
+    static std::vector<Shard*> shards;
+    static Shard               retired;
+
+    static std::atomic<int64_t> inFlight;
+    static std::atomic<int64_t> executorQueued;
+};
+
+#endif
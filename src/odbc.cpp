@@ -22,12 +22,15 @@
 #include "utils.h"
 #include "deferred_async_worker.h"
 #include "odbc_connection.h"
+#include "metrics.h"
 
 #ifdef dynodbc
 #include "dynodbc.h"
 #endif
 
-uv_mutex_t ODBC::g_odbcMutex;
+// created before any module instance, worker_threads included, can use it
+std::shared_ptr<HandleLock> ODBC::globalLock = std::make_shared<HandleLock>();
+SQLUINTEGER ODBC::connectionPooling = SQL_CP_OFF;
 
 Napi::FunctionReference ODBC::constructor;
 
@@ -38,13 +41,23 @@ Napi::Object ODBC::Init(Napi::Env env, Napi::Object exports) {
   Napi::Function constructorFunction = DefineClass(env, "ODBC", {
     InstanceMethod("createConnection", &ODBC::CreateConnection),
 
+    StaticMethod("getMetrics", &ODBC::GetMetrics),
+
+    InstanceAccessor("threadPoolStats", &ODBC::ThreadPoolStatsGetter, nullptr),
+    InstanceAccessor("lockStats", &ODBC::LockStatsGetter, nullptr),
+    InstanceAccessor("connectionPooling", &ODBC::ConnectionPoolingGetter, nullptr),
+
     // instance values [THESE WERE 'constant_attributes' in NAN, is there an equivalent here?]
     StaticValue("SQL_CLOSE", Napi::Number::New(env, SQL_CLOSE)),
     StaticValue("SQL_DROP", Napi::Number::New(env, SQL_DROP)),
     StaticValue("SQL_UNBIND", Napi::Number::New(env, SQL_UNBIND)),
     StaticValue("SQL_RESET_PARAMS", Napi::Number::New(env, SQL_RESET_PARAMS)),
     StaticValue("SQL_DESTROY", Napi::Number::New(env, SQL_DESTROY)),
-    StaticValue("SQL_USER_NAME", Napi::Number::New(env, SQL_USER_NAME))
+    StaticValue("SQL_USER_NAME", Napi::Number::New(env, SQL_USER_NAME)),
+    StaticValue("SQL_TXN_READ_UNCOMMITTED", Napi::Number::New(env, SQL_TXN_READ_UNCOMMITTED)),
+    StaticValue("SQL_TXN_READ_COMMITTED", Napi::Number::New(env, SQL_TXN_READ_COMMITTED)),
+    StaticValue("SQL_TXN_REPEATABLE_READ", Napi::Number::New(env, SQL_TXN_REPEATABLE_READ)),
+    StaticValue("SQL_TXN_SERIALIZABLE", Napi::Number::New(env, SQL_TXN_SERIALIZABLE))
   });
 
   constructor = Napi::Persistent(constructorFunction);
@@ -52,9 +65,6 @@ Napi::Object ODBC::Init(Napi::Env env, Napi::Object exports) {
 
   exports.Set("ODBC", constructorFunction);
 
-  // Initialize the cross platform mutex provided by libuv
-  uv_mutex_init(&ODBC::g_odbcMutex);
-
   return exports;
 }
 
@@ -65,23 +75,169 @@ ODBC::ODBC(const Napi::CallbackInfo& info) : Napi::ObjectWrap<ODBC>(info) {
 
   this->m_hEnv = NULL;
 
-  uv_mutex_lock(&ODBC::g_odbcMutex);
+  // new ODBC({ globalLock: true }) serializes the environment and all of its
+  // connections on one process wide lock, for drivers that aren't thread safe
+  Napi::Value globalLockOption = env.Undefined();
 
-  // Initialize the Environment handle
-  int ret = SQLAllocHandle(SQL_HANDLE_ENV, SQL_NULL_HANDLE, &m_hEnv);
+  // new ODBC({ sharedEnvironment: true | 'thread' | false }) picks whether
+  // the environment handle is shared with other ODBC objects in the process
+  // (the default), in this JavaScript thread only, or not at all
+  Napi::Value sharedOption = env.Undefined();
 
-  uv_mutex_unlock(&ODBC::g_odbcMutex);
+  if (info.Length() > 0 && info[0].IsObject()) {
+    globalLockOption = info[0].As<Napi::Object>().Get("globalLock");
+    sharedOption = info[0].As<Napi::Object>().Get("sharedEnvironment");
+  }
 
-  if (!SQL_SUCCEEDED(ret)) {
+  bool globalLock = globalLockOption.IsBoolean() && globalLockOption.As<Napi::Boolean>().Value();
+  bool shared = true;
+  napi_env owner = NULL;
+
+  if (sharedOption.IsBoolean()) {
+    shared = sharedOption.As<Napi::Boolean>().Value();
+  } else if (sharedOption.IsString() && sharedOption.As<Napi::String>().Utf8Value() == "thread") {
+    owner = env;
+  } else if (!sharedOption.IsUndefined()) {
+    Napi::TypeError::New(env, "[node-odbc] sharedEnvironment must be a boolean or 'thread'").ThrowAsJavaScriptException();
+    return;
+  }
+
+  // new ODBC({ connectionPooling: true | 'driver' | 'environment' }) turns
+  // on driver manager connection pooling: SQLDisconnect hands the physical
+  // connection back to the driver manager and the next SQLDriverConnect with
+  // a matching connection string gets it back without logging in again.
+  // Pooling is a process wide setting that has to be made before the
+  // environment is allocated, so it stays on once any environment asked for
+  // it; 'driver' shares the pool between all environments, 'environment'
+  // keeps one per environment. poolMatch: 'strict' | 'relaxed' picks how
+  // closely connection attributes have to match for a connection to be reused.
+  SQLUINTEGER pooling = SQL_CP_OFF;
+  SQLUINTEGER poolMatch = SQL_CP_STRICT_MATCH;
+  bool poolMatchSet = false;
+
+  if (info.Length() > 0 && info[0].IsObject()) {
+    Napi::Object options = info[0].As<Napi::Object>();
+    Napi::Value poolingOption = options.Get("connectionPooling");
+    Napi::Value poolMatchOption = options.Get("poolMatch");
+
+    if (poolingOption.IsBoolean()) {
+      pooling = poolingOption.As<Napi::Boolean>().Value() ? SQL_CP_ONE_PER_DRIVER : SQL_CP_OFF;
+    } else if (poolingOption.IsString() && poolingOption.As<Napi::String>().Utf8Value() == "driver") {
+      pooling = SQL_CP_ONE_PER_DRIVER;
+    } else if (poolingOption.IsString() && poolingOption.As<Napi::String>().Utf8Value() == "environment") {
+      pooling = SQL_CP_ONE_PER_HENV;
+    } else if (!poolingOption.IsUndefined()) {
+      Napi::TypeError::New(env, "[node-odbc] connectionPooling must be a boolean, 'driver' or 'environment'").ThrowAsJavaScriptException();
+      return;
+    }
+
+    if (poolMatchOption.IsString() && poolMatchOption.As<Napi::String>().Utf8Value() == "strict") {
+      poolMatchSet = true;
+    } else if (poolMatchOption.IsString() && poolMatchOption.As<Napi::String>().Utf8Value() == "relaxed") {
+      poolMatch = SQL_CP_RELAXED_MATCH;
+      poolMatchSet = true;
+    } else if (!poolMatchOption.IsUndefined()) {
+      Napi::TypeError::New(env, "[node-odbc] poolMatch must be 'strict' or 'relaxed'").ThrowAsJavaScriptException();
+      return;
+    }
+  }
+
+  ODBC::globalLock->Lock();
+
+  if (pooling != SQL_CP_OFF && pooling != ODBC::connectionPooling) {
+    if (!SQL_SUCCEEDED(SQLSetEnvAttr(SQL_NULL_HANDLE, SQL_ATTR_CONNECTION_POOLING, (SQLPOINTER)(uintptr_t) pooling, SQL_IS_UINTEGER))) {
+      ODBC::globalLock->Unlock();
+      Napi::Error::New(env, "[node-odbc] The driver manager does not support connection pooling").ThrowAsJavaScriptException();
+      return;
+    }
+
+    ODBC::connectionPooling = pooling;
+  }
+
+  poolMatchSet = poolMatchSet && ODBC::connectionPooling != SQL_CP_OFF;
+
+  ODBC::globalLock->Unlock();
+
+  // Initialize the Environment handle
+  if (shared) {
+    this->environment = Environment::Shared(owner, globalLock, poolMatch, poolMatchSet);
+  } else {
+    this->environment = std::make_shared<Environment>(globalLock, poolMatch, poolMatchSet);
+  }
+
+  if (!SQL_SUCCEEDED(this->environment->sqlReturnCode)) {
 
     DEBUG_PRINTF("ODBC::New - ERROR ALLOCATING ENV HANDLE!!\n");
 
-    Napi::Error(env, GetSQLError(env, SQL_HANDLE_ENV, this->m_hEnv)).ThrowAsJavaScriptException();
+    Napi::Error(env, GetSQLError(env, SQL_HANDLE_ENV, this->environment->hEnv)).ThrowAsJavaScriptException();
+    this->environment.reset();
     return;
   }
 
-  // Use ODBC 3.x behavior
-  SQLSetEnvAttr(this->m_hEnv, SQL_ATTR_ODBC_VERSION, (SQLPOINTER) SQL_OV_ODBC3, SQL_IS_UINTEGER);
+  this->m_hEnv = this->environment->hEnv;
+  this->lock = this->environment->lock;
+
+  // new ODBC({ threadPoolSize: n }) runs the work of all its connections on n
+  // threads of its own instead of the libuv threadpool
+  if (info.Length() > 0 && info[0].IsObject()) {
+    Napi::Value threadPoolSize = info[0].As<Napi::Object>().Get("threadPoolSize");
+
+    if (threadPoolSize.IsNumber() && threadPoolSize.As<Napi::Number>().Int32Value() > 0) {
+      this->executor = std::make_shared<Executor>(env, threadPoolSize.As<Napi::Number>().Uint32Value());
+    }
+  }
+}
+
+/*
+ * GetMetrics
+ *
+ *   ODBC.getMetrics() returns the process wide Metrics of every environment
+ *   and connection, merged from all threads (see Metrics::Snapshot).
+ */
+Napi::Value ODBC::GetMetrics(const Napi::CallbackInfo& info) {
+
+  Napi::Env env = info.Env();
+  Napi::HandleScope scope(env);
+
+  return Metrics::Snapshot(env);
+}
+
+Napi::Value ODBC::ThreadPoolStatsGetter(const Napi::CallbackInfo& info) {
+
+  Napi::Env env = info.Env();
+  Napi::HandleScope scope(env);
+
+  if (!this->executor) {
+    return env.Undefined();
+  }
+
+  return this->executor->Stats(env);
+}
+
+Napi::Value ODBC::ConnectionPoolingGetter(const Napi::CallbackInfo& info) {
+
+  Napi::Env env = info.Env();
+  Napi::HandleScope scope(env);
+
+  ODBC::globalLock->Lock();
+  SQLUINTEGER pooling = ODBC::connectionPooling;
+  ODBC::globalLock->Unlock();
+
+  if (pooling == SQL_CP_ONE_PER_DRIVER) {
+    return Napi::String::New(env, "driver");
+  } else if (pooling == SQL_CP_ONE_PER_HENV) {
+    return Napi::String::New(env, "environment");
+  }
+
+  return Napi::Boolean::New(env, false);
+}
+
+Napi::Value ODBC::LockStatsGetter(const Napi::CallbackInfo& info) {
+
+  Napi::Env env = info.Env();
+  Napi::HandleScope scope(env);
+
+  return this->lock->Stats(env);
 }
 
 ODBC::~ODBC() {
@@ -91,35 +247,38 @@ ODBC::~ODBC() {
 
 void ODBC::Free() {
   DEBUG_PRINTF("ODBC::Free\n");
-  uv_mutex_lock(&ODBC::g_odbcMutex);
-
-  if (m_hEnv) {
-    SQLFreeHandle(SQL_HANDLE_ENV, m_hEnv);
-    m_hEnv = NULL;
-  }
 
-  uv_mutex_unlock(&ODBC::g_odbcMutex);
+  // the handle itself is freed once no other ODBC object or connection is
+  // using it
+  this->environment.reset();
+  m_hEnv = NULL;
 }
 
 /*
  * CreateConnection
+ *
+ *   createConnection(options?) resolves to a new ODBCConnection. With
+ *   { dedicatedThread: true } the connection runs all of its work, and that
+ *   of its statements and results, on a thread of its own (see Executor);
+ *   otherwise it shares the environment's thread pool, or the libuv
+ *   threadpool if there is none.
  */
 
 class CreateConnectionAsyncWorker : public DeferredAsyncWorker {
 
   public:
-    CreateConnectionAsyncWorker(ODBC *odbcObject, Napi::Promise::Deferred deferred)
-      : DeferredAsyncWorker(deferred), odbcObject(odbcObject) {}
+    CreateConnectionAsyncWorker(ODBC *odbcObject, bool dedicatedThread, Napi::Promise::Deferred deferred)
+      : DeferredAsyncWorker(deferred), odbcObject(odbcObject), dedicatedThread(dedicatedThread) {}
 
     ~CreateConnectionAsyncWorker() {}
 
     void Execute() {
       DEBUG_PRINTF("ODBC::CreateConnectionAsyncWorker::Execute\n");
 
-      uv_mutex_lock(&ODBC::g_odbcMutex);
+      odbcObject->lock->Lock();
       //allocate a new connection handle
       sqlReturnCode = SQLAllocHandle(SQL_HANDLE_DBC, odbcObject->m_hEnv, &hDBC);
-      uv_mutex_unlock(&ODBC::g_odbcMutex);
+      odbcObject->lock->Unlock();
     }
 
     void OnOK() {
@@ -141,6 +300,18 @@ class CreateConnectionAsyncWorker : public DeferredAsyncWorker {
         std::vector<napi_value> connectionArguments;
         connectionArguments.push_back(Napi::External<SQLHENV>::New(env, &(odbcObject->m_hEnv))); // connectionArguments[0]
         connectionArguments.push_back(Napi::External<SQLHDBC>::New(env, &hDBC));   // connectionArguments[1]
+        connectionArguments.push_back(Napi::Boolean::New(env, dedicatedThread));   // connectionArguments[2]
+        connectionArguments.push_back(Napi::External<std::shared_ptr<Executor>>::New(env, &(odbcObject->executor))); // connectionArguments[3]
+
+        // the connection gets a lock of its own, unless the environment is
+        // serialized on the global one
+        std::shared_ptr<HandleLock> connectionLock = odbcObject->lock;
+        if (connectionLock != ODBC::globalLock) {
+          connectionLock = std::make_shared<HandleLock>();
+        }
+
+        connectionArguments.push_back(Napi::External<std::shared_ptr<Environment>>::New(env, &(odbcObject->environment))); // connectionArguments[4]
+        connectionArguments.push_back(Napi::External<std::shared_ptr<HandleLock>>::New(env, &connectionLock));     // connectionArguments[5]
 
         // Create a new ODBCConnection object as a Napi::Value
         Napi::Value connectionObject = ODBCConnection::constructor.New(connectionArguments);
@@ -151,6 +322,7 @@ class CreateConnectionAsyncWorker : public DeferredAsyncWorker {
 
   private:
     ODBC *odbcObject;
+    bool dedicatedThread;
     SQLRETURN sqlReturnCode;
     SQLHDBC hDBC;
 };
@@ -162,10 +334,17 @@ Napi::Value ODBC::CreateConnection(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
   Napi::HandleScope scope(env);
 
+  bool dedicatedThread = false;
+
+  if (info.Length() > 0 && info[0].IsObject()) {
+    Napi::Value dedicatedThreadOption = info[0].As<Napi::Object>().Get("dedicatedThread");
+    dedicatedThread = dedicatedThreadOption.IsBoolean() && dedicatedThreadOption.As<Napi::Boolean>().Value();
+  }
+
   Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(info.Env());
 
-  CreateConnectionAsyncWorker *worker = new CreateConnectionAsyncWorker(this, deferred);
-  worker->Queue();
+  CreateConnectionAsyncWorker *worker = new CreateConnectionAsyncWorker(this, dedicatedThread, deferred);
+  worker->Queue(this->executor);
 
   return deferred.Promise();
 }
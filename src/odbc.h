@@ -22,11 +22,19 @@
 #include <napi.h>
 
 #include "declarations.h"
+#include "environment.h"
+#include "executor.h"
+#include "handle_lock.h"
 
 class ODBC : public Napi::ObjectWrap<ODBC> {
   public:
     static Napi::FunctionReference constructor;
-    static uv_mutex_t g_odbcMutex;
+    // the one lock shared by every environment created with globalLock: true,
+    // and by their connections; also taken to allocate and free environments
+    static std::shared_ptr<HandleLock> globalLock;
+    // the driver manager's process wide SQL_ATTR_CONNECTION_POOLING, guarded
+    // by globalLock
+    static SQLUINTEGER connectionPooling;
 
     static Napi::Object Init(Napi::Env env, Napi::Object exports);
 
@@ -41,7 +49,24 @@ class ODBC : public Napi::ObjectWrap<ODBC> {
     SQLHENV m_hEnv;
     SQLHDBC m_hDBC;
 
+    // shared with other ODBC objects unless created with sharedEnvironment:
+    // false, and with every connection created from this one
+    std::shared_ptr<Environment> environment;
+
+    // guards the environment's connection handles, ODBC::globalLock when the
+    // environment was created with globalLock: true
+    std::shared_ptr<HandleLock> lock;
+
+    // set when the environment was created with a threadPoolSize
+    std::shared_ptr<Executor> executor;
+
     Napi::Value CreateConnection(const Napi::CallbackInfo& info);
+
+    static Napi::Value GetMetrics(const Napi::CallbackInfo& info);
+
+    Napi::Value ThreadPoolStatsGetter(const Napi::CallbackInfo& info);
+    Napi::Value LockStatsGetter(const Napi::CallbackInfo& info);
+    Napi::Value ConnectionPoolingGetter(const Napi::CallbackInfo& info);
 };
 
 #endif
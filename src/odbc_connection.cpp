@@ -41,15 +41,30 @@ Napi::Object ODBCConnection::Init(Napi::Env env, Napi::Object exports) {
     InstanceMethod("close", &ODBCConnection::Close),
     InstanceMethod("createStatement", &ODBCConnection::CreateStatement),
     InstanceMethod("query", &ODBCConnection::Query),
+    InstanceMethod("queryAll", &ODBCConnection::QueryAll),
+    InstanceMethod("batch", &ODBCConnection::Batch),
+    InstanceMethod("transaction", &ODBCConnection::Transaction),
+    InstanceMethod("cacheStatements", &ODBCConnection::CacheStatements),
     InstanceMethod("beginTransaction", &ODBCConnection::BeginTransaction),
     InstanceMethod("endTransaction", &ODBCConnection::EndTransaction),
     InstanceMethod("getInfo", &ODBCConnection::GetInfo),
+    InstanceMethod("isAlive", &ODBCConnection::IsAlive),
+    InstanceMethod("reset", &ODBCConnection::Reset),
     InstanceMethod("columns", &ODBCConnection::Columns),
     InstanceMethod("tables", &ODBCConnection::Tables),
 
     InstanceAccessor("connected", &ODBCConnection::ConnectedGetter, nullptr),
     InstanceAccessor("connectTimeout", &ODBCConnection::ConnectTimeoutGetter, &ODBCConnection::ConnectTimeoutSetter),
-    InstanceAccessor("loginTimeout", &ODBCConnection::LoginTimeoutGetter, &ODBCConnection::LoginTimeoutSetter)
+    InstanceAccessor("loginTimeout", &ODBCConnection::LoginTimeoutGetter, &ODBCConnection::LoginTimeoutSetter),
+    InstanceAccessor("statementCacheSize", &ODBCConnection::StatementCacheSizeGetter, &ODBCConnection::StatementCacheSizeSetter),
+    InstanceAccessor("statementCacheStats", &ODBCConnection::StatementCacheStatsGetter, nullptr),
+    InstanceAccessor("statementPoolSize", &ODBCConnection::StatementPoolSizeGetter, &ODBCConnection::StatementPoolSizeSetter),
+    InstanceAccessor("statementPoolStats", &ODBCConnection::StatementPoolStatsGetter, nullptr),
+    InstanceAccessor("asyncExecution", &ODBCConnection::AsyncExecutionGetter, &ODBCConnection::AsyncExecutionSetter),
+    InstanceAccessor("dedicatedThread", &ODBCConnection::DedicatedThreadGetter, nullptr),
+    InstanceAccessor("readOnly", &ODBCConnection::ReadOnlyGetter, &ODBCConnection::ReadOnlySetter),
+    InstanceAccessor("lockStats", &ODBCConnection::LockStatsGetter, nullptr),
+    InstanceAccessor("capabilities", &ODBCConnection::CapabilitiesGetter, nullptr)
   });
 
   constructor = Napi::Persistent(constructorFunction);
@@ -64,12 +79,42 @@ ODBCConnection::ODBCConnection(const Napi::CallbackInfo& info) : Napi::ObjectWra
 
   this->m_hENV = *(info[0].As<Napi::External<SQLHENV>>().Data());
   this->m_hDBC = *(info[1].As<Napi::External<SQLHDBC>>().Data());
+  this->connected = false;
+  this->initialIsolation = 0;
+  this->initialAccessMode = -1;
+  this->initialCatalog[0] = 0;
+  memset(&this->capabilities, 0, sizeof(this->capabilities));
+  this->environment = *(info[4].As<Napi::External<std::shared_ptr<Environment>>>().Data());
+  this->environmentLock = this->environment->lock;
+  this->connectionLock = *(info[5].As<Napi::External<std::shared_ptr<HandleLock>>>().Data());
 
   //set default connectTimeout to 0 seconds
   this->connectTimeout = 0;
   //set default loginTimeout to 5 seconds
   this->loginTimeout = 5;
 
+  //statements block a worker thread unless asyncExecution is turned on
+  this->asyncExecution = false;
+  this->asyncExecutionSupported = true;
+
+  //sessions are read-write unless readOnly is set before open
+  this->readOnly = false;
+
+  //keep up to 4 reset statement handles around for reuse
+  this->statementPool = std::make_shared<StatementPool>(this->m_hDBC, this->connectionLock, 4);
+
+  //the prepared statement cache is disabled until statementCacheSize is set
+  this->statementCache = std::make_shared<StatementCache>(this->statementPool, 0);
+
+  //work goes to a thread of the connection's own if createConnection was asked
+  //for one, else to the environment's thread pool, else the libuv threadpool
+  this->dedicatedThread = info.Length() > 2 && info[2].IsBoolean() && info[2].As<Napi::Boolean>().Value();
+
+  if (this->dedicatedThread) {
+    this->executor = std::make_shared<Executor>(info.Env(), 1);
+  } else if (info.Length() > 3 && info[3].IsExternal()) {
+    this->executor = *(info[3].As<Napi::External<std::shared_ptr<Executor>>>().Data());
+  }
 }
 
 ODBCConnection::~ODBCConnection() {
@@ -84,15 +129,20 @@ void ODBCConnection::Free(SQLRETURN *sqlReturnCode) {
 
   DEBUG_PRINTF("ODBCConnection::Free\n");
 
-  uv_mutex_lock(&ODBC::g_odbcMutex);
+  // free the cached and pooled statements while the connection is still there
+  this->statementCache->Close();
+  this->statementPool->Close();
 
-    if (m_hDBC) {
-      SQLDisconnect(m_hDBC);
-      SQLFreeHandle(SQL_HANDLE_DBC, m_hDBC);
-      m_hDBC = NULL;
-    }
+  if (m_hDBC) {
+    this->connectionLock->Lock();
+    SQLDisconnect(m_hDBC);
+    this->connectionLock->Unlock();
 
-  uv_mutex_unlock(&ODBC::g_odbcMutex);
+    this->environmentLock->Lock();
+    SQLFreeHandle(SQL_HANDLE_DBC, m_hDBC);
+    m_hDBC = NULL;
+    this->environmentLock->Unlock();
+  }
 
   return;
 
@@ -185,18 +235,259 @@ void ODBCConnection::LoginTimeoutSetter(const Napi::CallbackInfo& info, const Na
   }
 }
 
+Napi::Value ODBCConnection::StatementCacheSizeGetter(const Napi::CallbackInfo& info) {
+
+  Napi::Env env = info.Env();
+  Napi::HandleScope scope(env);
+
+  return Napi::Number::New(env, this->statementCache->Capacity());
+}
+
+void ODBCConnection::StatementCacheSizeSetter(const Napi::CallbackInfo& info, const Napi::Value& value) {
+
+  Napi::Env env = info.Env();
+  Napi::HandleScope scope(env);
+
+  if (value.IsNumber()) {
+    this->statementCache->SetCapacity(value.As<Napi::Number>().Uint32Value());
+  }
+}
+
+Napi::Value ODBCConnection::StatementCacheStatsGetter(const Napi::CallbackInfo& info) {
+
+  Napi::Env env = info.Env();
+  Napi::HandleScope scope(env);
+
+  return this->statementCache->Stats(env);
+}
+
+Napi::Value ODBCConnection::StatementPoolSizeGetter(const Napi::CallbackInfo& info) {
+
+  Napi::Env env = info.Env();
+  Napi::HandleScope scope(env);
+
+  return Napi::Number::New(env, this->statementPool->MaxIdle());
+}
+
+void ODBCConnection::StatementPoolSizeSetter(const Napi::CallbackInfo& info, const Napi::Value& value) {
+
+  Napi::Env env = info.Env();
+  Napi::HandleScope scope(env);
+
+  if (value.IsNumber()) {
+    this->statementPool->SetMaxIdle(value.As<Napi::Number>().Uint32Value());
+  }
+}
+
+Napi::Value ODBCConnection::StatementPoolStatsGetter(const Napi::CallbackInfo& info) {
+
+  Napi::Env env = info.Env();
+  Napi::HandleScope scope(env);
+
+  return this->statementPool->Stats(env);
+}
+
+Napi::Value ODBCConnection::AsyncExecutionGetter(const Napi::CallbackInfo& info) {
+
+  Napi::Env env = info.Env();
+  Napi::HandleScope scope(env);
+
+  return Napi::Boolean::New(env, this->asyncExecution && this->asyncExecutionSupported);
+}
+
+void ODBCConnection::AsyncExecutionSetter(const Napi::CallbackInfo& info, const Napi::Value& value) {
+
+  Napi::Env env = info.Env();
+  Napi::HandleScope scope(env);
+
+  if (value.IsBoolean()) {
+    this->asyncExecution = value.As<Napi::Boolean>().Value();
+  }
+}
+
+Napi::Value ODBCConnection::DedicatedThreadGetter(const Napi::CallbackInfo& info) {
+
+  Napi::Env env = info.Env();
+  Napi::HandleScope scope(env);
+
+  return Napi::Boolean::New(env, this->dedicatedThread);
+}
+
+Napi::Value ODBCConnection::ReadOnlyGetter(const Napi::CallbackInfo& info) {
+
+  Napi::Env env = info.Env();
+  Napi::HandleScope scope(env);
+
+  return Napi::Boolean::New(env, this->readOnly);
+}
+
+void ODBCConnection::ReadOnlySetter(const Napi::CallbackInfo& info, const Napi::Value& value) {
+
+  Napi::Env env = info.Env();
+  Napi::HandleScope scope(env);
+
+  // applied by open(), like connectTimeout and loginTimeout
+  if (value.IsBoolean()) {
+    this->readOnly = value.As<Napi::Boolean>().Value();
+  }
+}
+
+Napi::Value ODBCConnection::LockStatsGetter(const Napi::CallbackInfo& info) {
+
+  Napi::Env env = info.Env();
+  Napi::HandleScope scope(env);
+
+  return this->connectionLock->Stats(env);
+}
+
+static Napi::String CapabilityString(Napi::Env env, SQLTCHAR *value) {
+  #ifdef UNICODE
+    return Napi::String::New(env, (const char16_t *) value);
+  #else
+    return Napi::String::New(env, (const char *) value);
+  #endif
+}
+
+/*
+ *  ODBCConnection::CapabilitiesGetter
+ *
+ *    Description: Returns what the driver reported about itself when the
+ *                 connection was opened, without another trip to the driver.
+ *                 undefined until the connection has been opened.
+ *
+ *    Return:
+ *      Napi::Value:
+ *        An object with driverName, driverVersion, driverOdbcVersion,
+ *        dbmsName, dbmsVersion, identifierQuoteChar,
+ *        maxConcurrentActivities (0 for no limit), maxIdentifierLength,
+ *        transactions ('none', 'dml', 'all', 'ddlCommit' or 'ddlIgnore'),
+ *        scrollOptions (an Array of 'forwardOnly', 'static', 'keysetDriven',
+ *        'dynamic' and 'mixed'), asyncMode ('none', 'connection' or
+ *        'statement'), paramArrayRowCounts ('batch', 'noBatch' or 'none'),
+ *        paramArraySelects ('batch', 'noBatch' or 'none'), getDataAnyColumn,
+ *        getDataAnyOrder, moreResults.
+ */
+Napi::Value ODBCConnection::CapabilitiesGetter(const Napi::CallbackInfo& info) {
+
+  Napi::Env env = info.Env();
+  Napi::HandleScope scope(env);
+
+  if (!this->connected) {
+    return env.Undefined();
+  }
+
+  Capabilities *capabilities = &(this->capabilities);
+  Napi::Object result = Napi::Object::New(env);
+
+  result.Set("driverName", CapabilityString(env, capabilities->driverName));
+  result.Set("driverVersion", CapabilityString(env, capabilities->driverVersion));
+  result.Set("driverOdbcVersion", CapabilityString(env, capabilities->driverOdbcVersion));
+  result.Set("dbmsName", CapabilityString(env, capabilities->dbmsName));
+  result.Set("dbmsVersion", CapabilityString(env, capabilities->dbmsVersion));
+  result.Set("identifierQuoteChar", CapabilityString(env, capabilities->identifierQuoteChar));
+  result.Set("maxConcurrentActivities", Napi::Number::New(env, capabilities->maxConcurrentActivities));
+  result.Set("maxIdentifierLength", Napi::Number::New(env, capabilities->maxIdentifierLength));
+
+  const char *transactions = "none";
+  switch (capabilities->txnCapable) {
+    case SQL_TC_DML:         transactions = "dml"; break;
+    case SQL_TC_ALL:         transactions = "all"; break;
+    case SQL_TC_DDL_COMMIT:  transactions = "ddlCommit"; break;
+    case SQL_TC_DDL_IGNORE:  transactions = "ddlIgnore"; break;
+  }
+  result.Set("transactions", Napi::String::New(env, transactions));
+
+  Napi::Array scrollOptions = Napi::Array::New(env);
+  if (capabilities->scrollOptions & SQL_SO_FORWARD_ONLY)  scrollOptions.Set(scrollOptions.Length(), Napi::String::New(env, "forwardOnly"));
+  if (capabilities->scrollOptions & SQL_SO_STATIC)        scrollOptions.Set(scrollOptions.Length(), Napi::String::New(env, "static"));
+  if (capabilities->scrollOptions & SQL_SO_KEYSET_DRIVEN) scrollOptions.Set(scrollOptions.Length(), Napi::String::New(env, "keysetDriven"));
+  if (capabilities->scrollOptions & SQL_SO_DYNAMIC)       scrollOptions.Set(scrollOptions.Length(), Napi::String::New(env, "dynamic"));
+  if (capabilities->scrollOptions & SQL_SO_MIXED)         scrollOptions.Set(scrollOptions.Length(), Napi::String::New(env, "mixed"));
+  result.Set("scrollOptions", scrollOptions);
+
+  const char *asyncMode = "none";
+  if (capabilities->asyncMode == SQL_AM_CONNECTION) {
+    asyncMode = "connection";
+  } else if (capabilities->asyncMode == SQL_AM_STATEMENT) {
+    asyncMode = "statement";
+  }
+  result.Set("asyncMode", Napi::String::New(env, asyncMode));
+
+  const char *rowCounts = "none";
+  if (capabilities->paramArrayRowCounts == SQL_PARC_BATCH) {
+    rowCounts = "batch";
+  } else if (capabilities->paramArrayRowCounts == SQL_PARC_NO_BATCH) {
+    rowCounts = "noBatch";
+  }
+  result.Set("paramArrayRowCounts", Napi::String::New(env, rowCounts));
+
+  const char *selects = "none";
+  if (capabilities->paramArraySelects == SQL_PAS_BATCH) {
+    selects = "batch";
+  } else if (capabilities->paramArraySelects == SQL_PAS_NO_BATCH) {
+    selects = "noBatch";
+  }
+  result.Set("paramArraySelects", Napi::String::New(env, selects));
+
+  result.Set("getDataAnyColumn", Napi::Boolean::New(env, (capabilities->getDataExtensions & SQL_GD_ANY_COLUMN) != 0));
+  result.Set("getDataAnyOrder", Napi::Boolean::New(env, (capabilities->getDataExtensions & SQL_GD_ANY_ORDER) != 0));
+  result.Set("moreResults", Napi::Boolean::New(env, this->canHaveMoreResults == SQL_TRUE));
+
+  return result;
+}
+
 
 /******************************************************************************
  *********************************** OPEN *************************************
  *****************************************************************************/
 
+/*
+ *  ODBCConnection::ReadCapabilities
+ *
+ *    Description: Asks the driver for everything the capabilities accessor
+ *                 reports, once, on the worker thread that opened the
+ *                 connection (with connectionLock held). Anything the driver
+ *                 won't say is left empty or 0.
+ *
+ *                 A driver without statement level asynchronous execution
+ *                 never gets to try asyncExecution.
+ */
+void ODBCConnection::ReadCapabilities() {
+
+  Capabilities *capabilities = &(this->capabilities);
+  memset(capabilities, 0, sizeof(Capabilities));
+
+  SQLGetInfo(this->m_hDBC, SQL_DRIVER_NAME, capabilities->driverName, sizeof(capabilities->driverName), NULL);
+  SQLGetInfo(this->m_hDBC, SQL_DRIVER_VER, capabilities->driverVersion, sizeof(capabilities->driverVersion), NULL);
+  SQLGetInfo(this->m_hDBC, SQL_DRIVER_ODBC_VER, capabilities->driverOdbcVersion, sizeof(capabilities->driverOdbcVersion), NULL);
+  SQLGetInfo(this->m_hDBC, SQL_DBMS_NAME, capabilities->dbmsName, sizeof(capabilities->dbmsName), NULL);
+  SQLGetInfo(this->m_hDBC, SQL_DBMS_VER, capabilities->dbmsVersion, sizeof(capabilities->dbmsVersion), NULL);
+  SQLGetInfo(this->m_hDBC, SQL_IDENTIFIER_QUOTE_CHAR, capabilities->identifierQuoteChar, sizeof(capabilities->identifierQuoteChar), NULL);
+
+  SQLGetInfo(this->m_hDBC, SQL_MAX_CONCURRENT_ACTIVITIES, &(capabilities->maxConcurrentActivities), 0, NULL);
+  SQLGetInfo(this->m_hDBC, SQL_MAX_IDENTIFIER_LEN, &(capabilities->maxIdentifierLength), 0, NULL);
+  SQLGetInfo(this->m_hDBC, SQL_TXN_CAPABLE, &(capabilities->txnCapable), 0, NULL);
+
+  SQLGetInfo(this->m_hDBC, SQL_SCROLL_OPTIONS, &(capabilities->scrollOptions), 0, NULL);
+  SQLGetInfo(this->m_hDBC, SQL_PARAM_ARRAY_ROW_COUNTS, &(capabilities->paramArrayRowCounts), 0, NULL);
+  SQLGetInfo(this->m_hDBC, SQL_PARAM_ARRAY_SELECTS, &(capabilities->paramArraySelects), 0, NULL);
+  SQLGetInfo(this->m_hDBC, SQL_GETDATA_EXTENSIONS, &(capabilities->getDataExtensions), 0, NULL);
+
+  if (SQL_SUCCEEDED(SQLGetInfo(this->m_hDBC, SQL_ASYNC_MODE, &(capabilities->asyncMode), 0, NULL))
+      && capabilities->asyncMode != SQL_AM_STATEMENT) {
+    this->asyncExecutionSupported = false;
+  }
+}
+
  // OpenAsyncWorker, used by Open function (see below)
 class OpenAsyncWorker : public DeferredAsyncWorker {
 
   public:
     OpenAsyncWorker(ODBCConnection *odbcConnectionObject, SQLTCHAR *connectionStringPtr, Napi::Promise::Deferred deferred)
      : DeferredAsyncWorker(deferred), odbcConnectionObject(odbcConnectionObject),
-            connectionStringPtr(connectionStringPtr) {}
+            connectionStringPtr(connectionStringPtr) {
+      Measure(Metrics::OPEN);
+    }
 
     ~OpenAsyncWorker() {}
 
@@ -205,7 +496,8 @@ class OpenAsyncWorker : public DeferredAsyncWorker {
       DEBUG_PRINTF("ODBCConnection::OpenAsyncWorker::Execute : connectTimeout=%i, loginTimeout = %i\n",
         *&(odbcConnectionObject->connectTimeout), *&(odbcConnectionObject->loginTimeout));
 
-      uv_mutex_lock(&ODBC::g_odbcMutex);
+      // only this connection waits while the driver logs in
+      odbcConnectionObject->connectionLock->Lock();
 
       if (odbcConnectionObject->connectTimeout > 0) {
         //NOTE: SQLSetConnectAttr requires the thread to be locked
@@ -260,11 +552,37 @@ class OpenAsyncWorker : public DeferredAsyncWorker {
         //free the handle
         sqlReturnCode = SQLFreeHandle(SQL_HANDLE_STMT, hStmt);
 
+        odbcConnectionObject->ReadCapabilities();
+
+        //only a hint: drivers that can't enforce it may ignore it
+        if (odbcConnectionObject->readOnly) {
+          SQLSetConnectAttr(odbcConnectionObject->m_hDBC, SQL_ATTR_ACCESS_MODE, (SQLPOINTER) SQL_MODE_READ_ONLY, SQL_IS_UINTEGER);
+        }
+
+        //remember the session defaults so reset() can go back to them
+        if (!SQL_SUCCEEDED(SQLGetConnectAttr(odbcConnectionObject->m_hDBC, SQL_ATTR_TXN_ISOLATION,
+              &(odbcConnectionObject->initialIsolation), SQL_IS_UINTEGER, NULL))) {
+          odbcConnectionObject->initialIsolation = 0;
+        }
+
+        //read-only when opened with readOnly, so reset() keeps it that way
+        SQLUINTEGER accessMode = SQL_MODE_READ_WRITE;
+
+        if (SQL_SUCCEEDED(SQLGetConnectAttr(odbcConnectionObject->m_hDBC, SQL_ATTR_ACCESS_MODE,
+              &accessMode, SQL_IS_UINTEGER, NULL))) {
+          odbcConnectionObject->initialAccessMode = (SQLINTEGER) accessMode;
+        }
+
+        if (!SQL_SUCCEEDED(SQLGetConnectAttr(odbcConnectionObject->m_hDBC, SQL_ATTR_CURRENT_CATALOG,
+              odbcConnectionObject->initialCatalog, sizeof(odbcConnectionObject->initialCatalog), NULL))) {
+          odbcConnectionObject->initialCatalog[0] = 0;
+        }
+
       } else {
         SetError("null");
       }
 
-      uv_mutex_unlock(&ODBC::g_odbcMutex);
+      odbcConnectionObject->connectionLock->Unlock();
     }
 
     void OnOK() {
@@ -328,7 +646,7 @@ Napi::Value ODBCConnection::Open(const Napi::CallbackInfo& info) {
   Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(info.Env());
 
   OpenAsyncWorker *worker = new OpenAsyncWorker(this, connectionString, deferred);
-  worker->Queue();
+  worker->Queue(this->executor);
 
   return deferred.Promise();
 }
@@ -342,7 +660,9 @@ class CloseAsyncWorker : public DeferredAsyncWorker {
 
   public:
     CloseAsyncWorker(ODBCConnection *odbcConnectionObject, Napi::Promise::Deferred deferred)
-    : DeferredAsyncWorker(deferred), odbcConnectionObject(odbcConnectionObject) {}
+    : DeferredAsyncWorker(deferred), odbcConnectionObject(odbcConnectionObject) {
+      Measure(Metrics::CLOSE);
+    }
 
     ~CloseAsyncWorker() {}
 
@@ -403,7 +723,7 @@ Napi::Value ODBCConnection::Close(const Napi::CallbackInfo& info) {
   Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(info.Env());
 
   CloseAsyncWorker *worker = new CloseAsyncWorker(this, deferred);
-  worker->Queue();
+  worker->Queue(this->executor);
 
   return deferred.Promise();
 }
@@ -429,10 +749,7 @@ class CreateStatementAsyncWorker : public DeferredAsyncWorker {
        odbcConnectionObject->m_hDBC,
       );
 
-      uv_mutex_lock(&ODBC::g_odbcMutex);
-      sqlReturnCode = SQLAllocHandle( SQL_HANDLE_STMT, odbcConnectionObject->m_hDBC, &hSTMT);
-      uv_mutex_unlock(&ODBC::g_odbcMutex);
-
+      sqlReturnCode = odbcConnectionObject->statementPool->Checkout(&hSTMT);
 
       if (SQL_SUCCEEDED(sqlReturnCode)) {
         return;
@@ -457,6 +774,9 @@ class CreateStatementAsyncWorker : public DeferredAsyncWorker {
       statementArguments.push_back(Napi::External<HENV>::New(env, &(odbcConnectionObject->m_hENV)));
       statementArguments.push_back(Napi::External<HDBC>::New(env, &(odbcConnectionObject->m_hDBC)));
       statementArguments.push_back(Napi::External<HSTMT>::New(env, &hSTMT));
+      statementArguments.push_back(Napi::External<std::shared_ptr<StatementPool>>::New(env, &(odbcConnectionObject->statementPool)));
+      statementArguments.push_back(Napi::External<std::shared_ptr<Executor>>::New(env, &(odbcConnectionObject->executor)));
+      statementArguments.push_back(Napi::External<std::shared_ptr<HandleLock>>::New(env, &(odbcConnectionObject->connectionLock)));
 
       // create a new ODBCStatement object as a Napi::Value
       Napi::Value statementObject = ODBCStatement::constructor.New(statementArguments);
@@ -516,11 +836,49 @@ Napi::Value ODBCConnection::CreateStatement(const Napi::CallbackInfo& info) {
   Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(info.Env());
 
   CreateStatementAsyncWorker *worker = new CreateStatementAsyncWorker(this, deferred);
-  worker->Queue();
+  worker->Queue(this->executor);
 
   return deferred.Promise();
 }
 
+/*
+ *  ODBCConnection::StartAsyncExecution
+ *
+ *    Description: Runs a query through AsyncExecution if asyncExecution is
+ *                 on and the statement can run that way. Prepared (cached)
+ *                 statements and streamed parameters always take the blocking
+ *                 path. If the driver turns down SQL_ATTR_ASYNC_ENABLE, the
+ *                 connection stops trying.
+ *
+ *    Return:
+ *      bool:
+ *        true if the execution started and onComplete will be called; false
+ *        if the caller should queue its usual AsyncWorker.
+ */
+bool ODBCConnection::StartAsyncExecution(QueryData *data, Napi::Promise::Deferred deferred, AsyncExecution::Callback onComplete) {
+
+  if (!this->asyncExecution || !this->asyncExecutionSupported || !data->statementPool) {
+    return false;
+  }
+
+  // streamed parameters are fed from a worker thread
+  for (int i = 0; i < data->paramCount; i++) {
+    if (data->params[i].stream != NULL) {
+      return false;
+    }
+  }
+
+  AsyncExecution::Start(data, deferred, this->executor, [this, onComplete](QueryData *data, bool async) {
+    if (!async) {
+      // the driver turned down SQL_ATTR_ASYNC_ENABLE, don't ask again
+      this->asyncExecutionSupported = false;
+    }
+    onComplete(data, async);
+  });
+
+  return true;
+}
+
 /******************************************************************************
  ********************************** QUERY *************************************
  *****************************************************************************/
@@ -529,8 +887,14 @@ Napi::Value ODBCConnection::CreateStatement(const Napi::CallbackInfo& info) {
 class QueryAsyncWorker : public DeferredAsyncWorker {
 
   public:
-    QueryAsyncWorker(ODBCConnection *odbcConnectionObject, QueryData *data, Napi::Promise::Deferred deferred)
-    : DeferredAsyncWorker(deferred), odbcConnectionObject(odbcConnectionObject), data(data) {}
+    QueryAsyncWorker(ODBCConnection *odbcConnectionObject, QueryData *data, Napi::Promise::Deferred deferred, bool executed = false)
+    : DeferredAsyncWorker(deferred), odbcConnectionObject(odbcConnectionObject), data(data), executed(executed) {
+      if (executed) {
+        Measure(Metrics::QUERY, data->timings.queued);
+      } else {
+        Measure(Metrics::QUERY);
+      }
+    }
 
     ~QueryAsyncWorker() {}
 
@@ -541,33 +905,21 @@ class QueryAsyncWorker : public DeferredAsyncWorker {
       DEBUG_PRINTF("ODBCConnection::Query : sqlLen=%i, sqlSize=%i, sql=%s\n",
                data->sqlLen, data->sqlSize, (char*)data->sql);
 
-      // allocate a new statement handle
-      uv_mutex_lock(&ODBC::g_odbcMutex);
-      data->sqlReturnCode = SQLAllocHandle(SQL_HANDLE_STMT, odbcConnectionObject->m_hDBC, &(data->hSTMT));
-      uv_mutex_unlock(&ODBC::g_odbcMutex);
-
-      if (!SQL_SUCCEEDED(data->sqlReturnCode)) {
+      if (executed) {
+        // the statement already ran through AsyncExecution
+        if (SQL_SUCCEEDED(data->sqlReturnCode)) {
+          BindColumns(data);
+        } else {
+          SetError("ERROR");
+        }
         return;
       }
 
-      if (data->paramCount > 0) {
-        // binds all parameters to the query
-        BindParameters(data);
-      }
-
-      // execute the query directly
-      data->sqlReturnCode = SQLExecDirect(
-        data->hSTMT,
-        data->sql,
-        SQL_NTS
-      );
+      data->timings.started = uv_hrtime();
 
-      if (!SQL_SUCCEEDED(data->sqlReturnCode)) {
+      // runs the query on a cached, pooled or new statement handle
+      if (!SQL_SUCCEEDED(ExecuteQuery(data))) {
         SetError("ERROR");
-        return;
-      } else {
-        BindColumns(data);
-        return;
       }
     }
 
@@ -578,14 +930,18 @@ class QueryAsyncWorker : public DeferredAsyncWorker {
       Napi::Env env = Env();
       Napi::HandleScope scope(env);
 
+      // the statement has executed, aborting can't stop it any more
+      if (data->canceller) {
+        data->canceller->Unlisten();
+      }
+
       // no result object should be created, just return with true instead
       if (data->noResultObject) {
 
-        uv_mutex_lock(&ODBC::g_odbcMutex);
-
-        SQLFreeHandle(SQL_HANDLE_STMT, data->hSTMT);
+        ReleaseStatement(data);
 
-        uv_mutex_unlock(&ODBC::g_odbcMutex);
+        // there is no ODBCResult to own it
+        delete data;
 
         Resolve(Napi::Boolean::New(env, true));
       } else {
@@ -609,13 +965,22 @@ class QueryAsyncWorker : public DeferredAsyncWorker {
       Napi::Env env = Env();
       Napi::HandleScope scope(env);
 
-      Reject(GetSQLError(env, SQL_HANDLE_DBC, data->hSTMT,
-            (char *) "[node-odbc] Error in ODBCConnection::QueryAsyncWorker"));
+      if (data->canceller) {
+        data->canceller->Unlisten();
+      }
+
+      Reject(GetQueryError(env, data, (char *) "[node-odbc] Error in ODBCConnection::QueryAsyncWorker"));
+
+      // nothing will close a result for this handle, give it back now; the
+      // parameters (streams, pinned Buffers) go with it
+      ReleaseStatement(data);
+      delete data;
     }
 
   private:
     ODBCConnection *odbcConnectionObject;
     QueryData      *data;
+    bool            executed;
 };
 
 /*
@@ -630,11 +995,11 @@ class QueryAsyncWorker : public DeferredAsyncWorker {
  *
  *        info[0]: String: the SQL string to execute
  *        info[1?]: Array: optional array of parameters to bind to the query
- *        info[1/2]: Function: callback function:
- *            function(error, result)
- *              error: An error object if the connection was not opened, or
- *                     null if operation was successful.
- *              result: A string containing the info requested.
+ *        info[1/2?]: Object: optional options object:
+ *            timeout: SQL_ATTR_QUERY_TIMEOUT in seconds; the error of a query
+ *                     that times out has 'timedOut' set
+ *            signal: an AbortSignal that cancels the query with SQLCancel;
+ *                    the error is then an 'AbortError' with 'cancelled' set
  *
  *    Return:
  *      Napi::Value:
@@ -648,77 +1013,125 @@ Napi::Value ODBCConnection::Query(const Napi::CallbackInfo& info) {
   Napi::HandleScope scope(env);
 
   QueryData *data = new QueryData;
+  data->executor = this->executor;
+  data->connectionLock = this->connectionLock;
 
   Napi::String sql = info[0].ToString();
 
+  size_t optionsIndex = 1;
+
   // check if parameters were passed or not
-  if (info.Length() == 2 && info[1].IsArray()) {
+  if (info.Length() >= 2 && info[1].IsArray()) {
     Napi::Array parameterArray = info[1].As<Napi::Array>();
     data->params = GetParametersFromArray(&parameterArray, &(data->paramCount));
+    optionsIndex = 2;
   } else {
     data->params = 0;
   }
 
   Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(info.Env());
 
+  if (info.Length() > optionsIndex && !GetQueryOptions(env, info[optionsIndex], data)) {
+    delete data;
+    deferred.Reject(GetAbortError(env));
+    return deferred.Promise();
+  }
+
+  // parameterized queries are prepared once and reused through the cache
+  if (data->paramCount > 0 && this->statementCache->Capacity() > 0) {
+    data->statementCache = this->statementCache;
+  } else {
+    data->statementPool = this->statementPool;
+  }
+
   data->sql = NapiStringToSQLTCHAR(sql);
 
   // DEBUG_PRINTF("ODBCConnection::Query : sqlLen=%i, sqlSize=%i, sql=%s\n",
   //              data->sqlLen, data->sqlSize, (char*)data->sql);
 
+  data->timings.queued = uv_hrtime();
+
+  // long statements can wait on the server without holding a worker thread
+  bool started = StartAsyncExecution(data, deferred, [this, deferred](QueryData *data, bool async) {
+    QueryAsyncWorker *worker = new QueryAsyncWorker(this, data, deferred, async);
+    worker->Queue(this->executor);
+  });
+
+  if (started) {
+    return deferred.Promise();
+  }
+
   QueryAsyncWorker *worker = new QueryAsyncWorker(this, data, deferred);
-  worker->Queue();
+  worker->Queue(this->executor);
 
   return deferred.Promise();
 }
 
 /******************************************************************************
- ******************************** GET INFO ************************************
+ ******************************** QUERY ALL ***********************************
  *****************************************************************************/
 
-// GetInfoAsyncWorker, used by GetInfo function (see below)
-class GetInfoAsyncWorker : public DeferredAsyncWorker {
+// QueryAllAsyncWorker, used by QueryAll function (see below)
+class QueryAllAsyncWorker : public DeferredAsyncWorker {
 
   public:
-    GetInfoAsyncWorker(ODBCConnection *odbcConnectionObject, SQLUSMALLINT infoType, Napi::Promise::Deferred deferred)
-    : DeferredAsyncWorker(deferred), odbcConnectionObject(odbcConnectionObject), infoType(infoType) {}
+    QueryAllAsyncWorker(ODBCConnection *odbcConnectionObject, QueryData *data, Napi::Promise::Deferred deferred, bool executed = false)
+    : DeferredAsyncWorker(deferred), odbcConnectionObject(odbcConnectionObject), data(data), executed(executed) {
+      if (executed) {
+        Measure(Metrics::QUERY, data->timings.queued);
+      } else {
+        Measure(Metrics::QUERY);
+      }
+    }
 
-    ~GetInfoAsyncWorker() {}
+    ~QueryAllAsyncWorker() {
+      delete data;
+    }
 
     void Execute() {
 
-      DEBUG_PRINTF("ODBCConnection::GetInfoAsyncWorker:Execute");
-
-      switch (infoType) {
-        case SQL_USER_NAME:
+      DEBUG_PRINTF("ODBCConnection::QueryAllAsyncWorker::Execute\n");
 
-          sqlReturnCode = SQLGetInfo(odbcConnectionObject->m_hDBC, SQL_USER_NAME, userName, sizeof(userName), &userNameLength);
+      if (executed) {
+        // the statement already ran through AsyncExecution
+        if (!SQL_SUCCEEDED(data->sqlReturnCode)) {
+          SetError("ERROR");
+          return;
+        }
+        BindColumns(data);
+      } else {
+        data->timings.started = uv_hrtime();
 
-          if (SQL_SUCCEEDED(sqlReturnCode)) {
-           return;
-          } else {
-            SetError("Error");
-          }
+        if (!SQL_SUCCEEDED(ExecuteQuery(data))) {
+          SetError("ERROR");
+          return;
+        }
+      }
 
-        default:
-          SetError("Error");
+      //Only loop through the recordset if there are columns
+      if (data->columnCount > 0) {
+        FetchAllData(data);
       }
+
+      // the rows are copied out, the handle isn't needed any more
+      ReleaseStatement(data);
     }
 
     void OnOK() {
 
+      DEBUG_PRINTF("ODBCConnection::QueryAllAsyncWorker::OnOK\n");
+
       Napi::Env env = Env();
       Napi::HandleScope scope(env);
 
-      Napi::Value res;
+      if (data->canceller) {
+        data->canceller->Unlisten();
+      }
 
-      #ifdef UNICODE
-        res = Napi::String::New(env, (const char16_t *)userName);
-      #else
-        res = Napi::String::New(env, (const char *) userName);
-      #endif
+      Napi::Array rows = GetNapiRowData(env, &(data->storedRows), data->columns, data->columnCount, data->fetchMode);
+      data->timings.materialized = uv_hrtime();
 
-      Resolve(res);
+      Resolve(rows);
     }
 
     void OnError(const Napi::Error &e) {
@@ -726,57 +1139,1044 @@ class GetInfoAsyncWorker : public DeferredAsyncWorker {
       Napi::Env env = Env();
       Napi::HandleScope scope(env);
 
-      Reject(GetSQLError(env, SQL_HANDLE_DBC, odbcConnectionObject->m_hDBC,
-            (char *) "[node-odbc] Error in ODBCConnection::GetInfoAsyncWorker"));
+      if (data->canceller) {
+        data->canceller->Unlisten();
+      }
+
+      Reject(GetQueryError(env, data, (char *) "[node-odbc] Error in ODBCConnection::QueryAllAsyncWorker"));
+
+      ReleaseStatement(data);
     }
 
   private:
     ODBCConnection *odbcConnectionObject;
-    SQLUSMALLINT infoType;
-    SQLTCHAR userName[255];
-    SQLSMALLINT userNameLength;
-    SQLRETURN sqlReturnCode;
+    QueryData      *data;
+    bool            executed;
 };
 
 /*
- *  ODBCConnection::GetInfo
+ *  ODBCConnection::QueryAll
  *
- *    Description: Returns the info requested from the connection.
+ *    Description: Executes a query and fetches all of its rows in a single
+ *                 trip to the thread pool. The statement handle is released
+ *                 before the promise resolves, so no ODBCResult is created
+ *                 and nothing needs to be closed.
  *
  *    Parameters:
  *      const Napi::CallbackInfo& info:
  *        The information passed from the JavaSript environment, including the
- *        function arguments for 'getInfo'.
+ *        function arguments for 'queryAll'.
  *
- *        info[0]: Number: option
- *        info[4]: Function: callback function:
- *            function(error, result)
- *              error: An error object if the connection was not opened, or
- *                     null if operation was successful.
- *              result: A string containing the info requested.
+ *        info[0]: String: the SQL string to execute
+ *        info[1?]: Array: optional array of parameters to bind to the query
+ *        info[1/2?]: Object: optional options object:
+ *            fetchMode: return rows as objects (default) or arrays
+ *            timeout, signal: as for query()
  *
  *    Return:
  *      Napi::Value:
- *        Undefined (results returned in callback)
+ *        A Promise that resolves to the array of rows.
  */
-Napi::Value ODBCConnection::GetInfo(const Napi::CallbackInfo& info) {
+Napi::Value ODBCConnection::QueryAll(const Napi::CallbackInfo& info) {
 
-  DEBUG_PRINTF("ODBCConnection::GetInfo\n");
+  DEBUG_PRINTF("ODBCConnection::QueryAll\n");
 
   Napi::Env env = info.Env();
   Napi::HandleScope scope(env);
 
-  if ( !info[0].IsNumber() ) {
-    Napi::TypeError::New(env, "ODBCConnection::GetInfo(): Argument 0 must be a Number.").ThrowAsJavaScriptException();
+  if (info.Length() < 1 || !info[0].IsString()) {
+    Napi::TypeError::New(env, "queryAll() takes a SQL string as its first argument").ThrowAsJavaScriptException();
     return env.Null();
   }
 
-  SQLUSMALLINT infoType = info[0].As<Napi::Number>().Int32Value();
+  QueryData *data = new QueryData;
+  data->executor = this->executor;
+  data->connectionLock = this->connectionLock;
+  data->fetchMode = FETCH_OBJECT;
+
+  Napi::String sql = info[0].ToString();
+
+  size_t optionsIndex = 1;
+
+  // check if parameters were passed or not
+  if (info.Length() >= 2 && info[1].IsArray()) {
+    Napi::Array parameterArray = info[1].As<Napi::Array>();
+    data->params = GetParametersFromArray(&parameterArray, &(data->paramCount));
+    optionsIndex = 2;
+  } else {
+    data->params = 0;
+  }
+
+  Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(info.Env());
+
+  if (info.Length() > optionsIndex && !GetQueryOptions(env, info[optionsIndex], data)) {
+    delete data;
+    deferred.Reject(GetAbortError(env));
+    return deferred.Promise();
+  }
+
+  // parameterized queries are prepared once and reused through the cache
+  if (data->paramCount > 0 && this->statementCache->Capacity() > 0) {
+    data->statementCache = this->statementCache;
+  } else {
+    data->statementPool = this->statementPool;
+  }
+
+  data->sql = NapiStringToSQLTCHAR(sql);
+
+  data->timings.queued = uv_hrtime();
+
+  // long statements can wait on the server without holding a worker thread
+  bool started = StartAsyncExecution(data, deferred, [this, deferred](QueryData *data, bool async) {
+    QueryAllAsyncWorker *worker = new QueryAllAsyncWorker(this, data, deferred, async);
+    worker->Queue(this->executor);
+  });
+
+  if (started) {
+    return deferred.Promise();
+  }
+
+  QueryAllAsyncWorker *worker = new QueryAllAsyncWorker(this, data, deferred);
+  worker->Queue(this->executor);
+
+  return deferred.Promise();
+}
+
+/******************************************************************************
+ ********************************** BATCH *************************************
+ *****************************************************************************/
+
+// one statement of a batch, with what it produced on the worker thread
+typedef struct BatchStatement {
+  QueryData                     *data;
+  SQLLEN                         rowCount;
+  bool                           failed;
+  std::vector<DiagnosticRecord>  errors;
+} BatchStatement;
+
+// BatchAsyncWorker, used by Batch and Transaction functions (see below). In
+// transaction mode the statements run with autocommit off and are committed
+// together, or rolled back at the first failure.
+class BatchAsyncWorker : public DeferredAsyncWorker {
+
+  public:
+    BatchAsyncWorker(ODBCConnection *odbcConnectionObject, std::vector<BatchStatement> statements, bool stopOnError, Napi::Promise::Deferred deferred)
+    : DeferredAsyncWorker(deferred), odbcConnectionObject(odbcConnectionObject), statements(statements),
+        stopOnError(stopOnError), failedIndex(-1), transaction(false), isolation(0) {
+      Measure(Metrics::QUERY);
+    }
+
+    BatchAsyncWorker(ODBCConnection *odbcConnectionObject, std::vector<BatchStatement> statements, SQLUINTEGER isolation, Napi::Promise::Deferred deferred)
+    : DeferredAsyncWorker(deferred), odbcConnectionObject(odbcConnectionObject), statements(statements),
+        stopOnError(true), failedIndex(-1), transaction(true), isolation(isolation) {
+      Measure(Metrics::QUERY);
+    }
+
+    ~BatchAsyncWorker() {
+      for (size_t i = 0; i < statements.size(); i++) {
+        delete statements[i].data;
+      }
+    }
+
+    void Execute() {
+
+      DEBUG_PRINTF("ODBCConnection::BatchAsyncWorker::Execute\n");
+
+      if (transaction) {
+        ExecuteTransaction();
+        return;
+      }
+
+      if (!ExecuteStatements()) {
+        SetError("ERROR");
+      }
+    }
+
+    void ExecuteTransaction() {
+
+      SQLHDBC hDBC = odbcConnectionObject->m_hDBC;
+      SQLUINTEGER previousIsolation = 0;
+      SQLUINTEGER autocommit = SQL_AUTOCOMMIT_ON;
+      SQLRETURN sqlReturnCode;
+
+      // with autocommit off the caller has a transaction of its own open
+      // (beginTransaction), which committing or rolling back here would end
+      sqlReturnCode = SQLGetConnectAttr(hDBC, SQL_ATTR_AUTOCOMMIT, &autocommit, 0, NULL);
+
+      if (SQL_SUCCEEDED(sqlReturnCode) && autocommit == SQL_AUTOCOMMIT_OFF) {
+        nested = true;
+        SetError("ERROR");
+        return;
+      }
+
+      // the isolation level can only change outside of a transaction, so it
+      // is set (and put back afterwards) while autocommit is still on
+      if (isolation != 0) {
+        sqlReturnCode = SQLGetConnectAttr(hDBC, SQL_ATTR_TXN_ISOLATION, &previousIsolation, 0, NULL);
+
+        if (SQL_SUCCEEDED(sqlReturnCode)) {
+          sqlReturnCode = SQLSetConnectAttr(hDBC, SQL_ATTR_TXN_ISOLATION, (SQLPOINTER)(uintptr_t) isolation, SQL_IS_UINTEGER);
+        }
+
+        if (!SQL_SUCCEEDED(sqlReturnCode)) {
+          CaptureSQLError(SQL_HANDLE_DBC, hDBC, &connectionErrors);
+          SetError("ERROR");
+          return;
+        }
+      }
+
+      sqlReturnCode = SQLSetConnectAttr(hDBC, SQL_ATTR_AUTOCOMMIT, (SQLPOINTER) SQL_AUTOCOMMIT_OFF, SQL_NTS);
+
+      if (SQL_SUCCEEDED(sqlReturnCode)) {
+
+        bool succeeded = ExecuteStatements();
+
+        sqlReturnCode = SQLEndTran(SQL_HANDLE_DBC, hDBC, succeeded ? SQL_COMMIT : SQL_ROLLBACK);
+
+        if (succeeded && !SQL_SUCCEEDED(sqlReturnCode)) {
+          // the commit failed, nothing of the transaction may be left behind
+          CaptureSQLError(SQL_HANDLE_DBC, hDBC, &connectionErrors);
+          SQLEndTran(SQL_HANDLE_DBC, hDBC, SQL_ROLLBACK);
+        }
+
+        rolledBack = !succeeded || !SQL_SUCCEEDED(sqlReturnCode);
+
+        SQLSetConnectAttr(hDBC, SQL_ATTR_AUTOCOMMIT, (SQLPOINTER) SQL_AUTOCOMMIT_ON, SQL_NTS);
+      } else {
+        CaptureSQLError(SQL_HANDLE_DBC, hDBC, &connectionErrors);
+        rolledBack = true;
+      }
+
+      if (isolation != 0) {
+        SQLSetConnectAttr(hDBC, SQL_ATTR_TXN_ISOLATION, (SQLPOINTER)(uintptr_t) previousIsolation, SQL_IS_UINTEGER);
+      }
+
+      if (rolledBack) {
+        SetError("ERROR");
+      }
+    }
+
+    // runs the statements in order; false if one failed and stopOnError is set
+    bool ExecuteStatements() {
+
+      for (size_t i = 0; i < statements.size(); i++) {
+
+        BatchStatement *statement = &statements[i];
+        QueryData *data = statement->data;
+
+        if (SQL_SUCCEEDED(ExecuteQuery(data))) {
+
+          if (data->columnCount > 0) {
+            FetchAllData(data);
+          } else if (!SQL_SUCCEEDED(SQLRowCount(data->hSTMT, &statement->rowCount))) {
+            statement->rowCount = 0;
+          }
+
+        } else {
+
+          // the diagnostics go with the handle, keep a copy
+          statement->failed = true;
+
+          if (data->hSTMT != SQL_NULL_HSTMT) {
+            CaptureSQLError(SQL_HANDLE_STMT, data->hSTMT, &statement->errors);
+          } else {
+            CaptureSQLError(SQL_HANDLE_DBC, odbcConnectionObject->m_hDBC, &statement->errors);
+          }
+        }
+
+        ReleaseStatement(data);
+
+        if (statement->failed && failedIndex < 0) {
+          failedIndex = i;
+        }
+
+        if (statement->failed && stopOnError) {
+          return false;
+        }
+      }
+
+      return true;
+    }
+
+    void OnOK() {
+
+      DEBUG_PRINTF("ODBCConnection::BatchAsyncWorker::OnOK\n");
+
+      Napi::Env env = Env();
+      Napi::HandleScope scope(env);
+
+      Resolve(GetResults(env, statements.size()));
+    }
+
+    void OnError(const Napi::Error &e) {
+
+      DEBUG_PRINTF("ODBCConnection::BatchAsyncWorker::OnError\n");
+
+      Napi::Env env = Env();
+      Napi::HandleScope scope(env);
+
+      Napi::Value error;
+
+      if (nested) {
+        error = Napi::Error::New(env, "[node-odbc] transaction() cannot run while another transaction is open").Value();
+      } else if (failedIndex >= 0) {
+        error = GetStatementError(env, &statements[failedIndex]);
+
+        // tell the caller which statement failed and what the earlier ones did
+        if (error.IsObject()) {
+          error.As<Napi::Object>().Set(Napi::String::New(env, "index"), Napi::Number::New(env, failedIndex));
+          error.As<Napi::Object>().Set(Napi::String::New(env, "results"), GetResults(env, failedIndex));
+        }
+      } else {
+        // starting or committing the transaction failed
+        error = GetSQLError(env, &connectionErrors,
+              (char *) "[node-odbc] Error in ODBCConnection::BatchAsyncWorker");
+      }
+
+      if (transaction && error.IsObject()) {
+        error.As<Napi::Object>().Set(Napi::String::New(env, "rolledBack"), Napi::Boolean::New(env, rolledBack));
+      }
+
+      Reject(error);
+    }
+
+  private:
+    // rows for statements that returned a result set, the row count for the
+    // others, and the error for those that failed
+    Napi::Array GetResults(Napi::Env env, size_t count) {
+
+      Napi::Array results = Napi::Array::New(env, count);
+
+      for (size_t i = 0; i < count; i++) {
+
+        BatchStatement *statement = &statements[i];
+        QueryData *data = statement->data;
+
+        if (statement->failed) {
+          results.Set(i, GetStatementError(env, statement));
+        } else if (data->columnCount > 0) {
+          results.Set(i, GetNapiRowData(env, &(data->storedRows), data->columns, data->columnCount, data->fetchMode));
+        } else {
+          results.Set(i, Napi::Number::New(env, statement->rowCount));
+        }
+      }
+
+      return results;
+    }
+
+    Napi::Value GetStatementError(Napi::Env env, BatchStatement *statement) {
+
+      // a parameter stream that failed is reported with its own error
+      Napi::Value streamError = GetParameterStreamError(env, statement->data);
+
+      if (!streamError.IsUndefined()) {
+        return streamError;
+      }
+
+      return GetSQLError(env, &statement->errors,
+            (char *) "[node-odbc] Error in ODBCConnection::BatchAsyncWorker");
+    }
+
+    ODBCConnection *odbcConnectionObject;
+    std::vector<BatchStatement> statements;
+    bool stopOnError;
+    int failedIndex;
+
+    bool transaction;
+    bool rolledBack = false;
+    bool nested = false;
+    SQLUINTEGER isolation;
+    std::vector<DiagnosticRecord> connectionErrors;
+};
+
+/*
+ *  ODBCConnection::GetBatchStatements
+ *
+ *    Description: Turns the array passed to batch() into BatchStatements, each
+ *                 with its own QueryData set up like query() would.
+ *
+ *    Return:
+ *      bool:
+ *        false (with a pending JavaScript exception) if an entry is invalid.
+ */
+bool ODBCConnection::GetBatchStatements(Napi::Env env, Napi::Array array, int fetchMode, std::vector<BatchStatement> *statements) {
+
+  for (uint32_t i = 0; i < array.Length(); i++) {
+
+    Napi::Value entry = array.Get(i);
+    Napi::Value sql;
+    Napi::Value params;
+
+    // either a SQL string or { sql, params }
+    if (entry.IsString()) {
+      sql = entry;
+    } else if (entry.IsObject()) {
+      sql = entry.As<Napi::Object>().Get("sql");
+      params = entry.As<Napi::Object>().Get("params");
+    }
+
+    if (sql.IsEmpty() || !sql.IsString() || (!params.IsEmpty() && !params.IsUndefined() && !params.IsArray())) {
+      for (size_t j = 0; j < statements->size(); j++) {
+        delete (*statements)[j].data;
+      }
+      statements->clear();
+
+      Napi::TypeError::New(env, "Statements must be SQL strings or { sql, params } objects").ThrowAsJavaScriptException();
+      return false;
+    }
+
+    QueryData *data = new QueryData;
+    data->connectionLock = this->connectionLock;
+    data->fetchMode = fetchMode;
+    data->params = 0;
+
+    if (!params.IsEmpty() && params.IsArray()) {
+      Napi::Array parameterArray = params.As<Napi::Array>();
+      data->params = GetParametersFromArray(&parameterArray, &(data->paramCount));
+    }
+
+    // parameterized queries are prepared once and reused through the cache
+    if (data->paramCount > 0 && this->statementCache->Capacity() > 0) {
+      data->statementCache = this->statementCache;
+    } else {
+      data->statementPool = this->statementPool;
+    }
+
+    data->sql = NapiStringToSQLTCHAR(sql.As<Napi::String>());
+
+    BatchStatement statement = { data, 0, false, std::vector<DiagnosticRecord>() };
+    statements->push_back(statement);
+  }
+
+  return true;
+}
+
+/*
+ *  ODBCConnection::Batch
+ *
+ *    Description: Runs a list of statements one after another in a single
+ *                 AsyncWorker.
+ *
+ *    Parameters:
+ *      const Napi::CallbackInfo& info:
+ *        The information passed from the JavaSript environment, including the
+ *        function arguments for 'batch'.
+ *
+ *        info[0]: Array: SQL strings or { sql, params } objects
+ *        info[1?]: Object: optional options object:
+ *            stopOnError: stop at the first failing statement and reject
+ *                         (default true). When false, the failed statements
+ *                         get their error object in the results instead.
+ *            fetchMode: return rows as objects (default) or arrays
+ *
+ *    Return:
+ *      Napi::Value:
+ *        A Promise that resolves to an array with, for each statement, its
+ *        rows if it returned a result set, or else its row count. A rejection
+ *        has an 'index' property with the position of the failed statement
+ *        and 'results' for the statements before it.
+ */
+Napi::Value ODBCConnection::Batch(const Napi::CallbackInfo& info) {
+
+  DEBUG_PRINTF("ODBCConnection::Batch\n");
+
+  Napi::Env env = info.Env();
+  Napi::HandleScope scope(env);
+
+  if (info.Length() < 1 || !info[0].IsArray()) {
+    Napi::TypeError::New(env, "batch() takes an Array of statements").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  bool stopOnError = true;
+  int fetchMode = FETCH_OBJECT;
+
+  if (info.Length() > 1 && info[1].IsObject()) {
+    Napi::Object options = info[1].As<Napi::Object>();
+
+    if (options.Get("stopOnError").IsBoolean()) {
+      stopOnError = options.Get("stopOnError").As<Napi::Boolean>().Value();
+    }
+
+    if (options.Get("fetchMode").IsNumber()) {
+      fetchMode = options.Get("fetchMode").As<Napi::Number>().Int32Value();
+    }
+  }
+
+  std::vector<BatchStatement> statements;
+
+  if (!GetBatchStatements(env, info[0].As<Napi::Array>(), fetchMode, &statements)) {
+    return env.Null();
+  }
+
+  Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(info.Env());
+
+  BatchAsyncWorker *worker = new BatchAsyncWorker(this, statements, stopOnError, deferred);
+  worker->Queue(this->executor);
+
+  return deferred.Promise();
+}
+
+/*
+ *  ODBCConnection::Transaction
+ *
+ *    Description: Begins a transaction, runs a list of statements and commits
+ *                 them, all in a single AsyncWorker. The transaction is rolled
+ *                 back as soon as a statement fails.
+ *
+ *                 Autocommit is a property of the whole connection, so any
+ *                 other work running on the connection at the same time (a
+ *                 query() on another executor thread) becomes part of the
+ *                 transaction. transaction() must not run concurrently with
+ *                 other work on the same connection.
+ *
+ *    Parameters:
+ *      const Napi::CallbackInfo& info:
+ *        The information passed from the JavaSript environment, including the
+ *        function arguments for 'transaction'.
+ *
+ *        info[0]: Array: SQL strings or { sql, params } objects
+ *        info[1?]: Object: optional options object:
+ *            isolation: a SQL_TXN_* value, or one of 'READ UNCOMMITTED',
+ *                       'READ COMMITTED', 'REPEATABLE READ' or 'SERIALIZABLE'.
+ *                       The connection's level is restored afterwards.
+ *            fetchMode: return rows as objects (default) or arrays
+ *
+ *    Return:
+ *      Napi::Value:
+ *        A Promise that resolves to the per-statement results, like batch().
+ *        A rejection has 'rolledBack' set, and 'index' and 'results' if a
+ *        statement failed.
+ */
+Napi::Value ODBCConnection::Transaction(const Napi::CallbackInfo& info) {
+
+  DEBUG_PRINTF("ODBCConnection::Transaction\n");
+
+  Napi::Env env = info.Env();
+  Napi::HandleScope scope(env);
+
+  if (info.Length() < 1 || !info[0].IsArray()) {
+    Napi::TypeError::New(env, "transaction() takes an Array of statements").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  SQLUINTEGER isolation = 0;
+  int fetchMode = FETCH_OBJECT;
+
+  if (info.Length() > 1 && info[1].IsObject()) {
+    Napi::Object options = info[1].As<Napi::Object>();
+    Napi::Value isolationValue = options.Get("isolation");
+
+    if (isolationValue.IsNumber()) {
+      isolation = isolationValue.As<Napi::Number>().Uint32Value();
+
+      if (isolation != SQL_TXN_READ_UNCOMMITTED && isolation != SQL_TXN_READ_COMMITTED &&
+          isolation != SQL_TXN_REPEATABLE_READ && isolation != SQL_TXN_SERIALIZABLE) {
+        Napi::TypeError::New(env, "Unknown transaction isolation level").ThrowAsJavaScriptException();
+        return env.Null();
+      }
+    } else if (isolationValue.IsString()) {
+      std::string level = isolationValue.As<Napi::String>().Utf8Value();
+
+      if (level == "READ UNCOMMITTED") {
+        isolation = SQL_TXN_READ_UNCOMMITTED;
+      } else if (level == "READ COMMITTED") {
+        isolation = SQL_TXN_READ_COMMITTED;
+      } else if (level == "REPEATABLE READ") {
+        isolation = SQL_TXN_REPEATABLE_READ;
+      } else if (level == "SERIALIZABLE") {
+        isolation = SQL_TXN_SERIALIZABLE;
+      } else {
+        Napi::TypeError::New(env, "Unknown transaction isolation level").ThrowAsJavaScriptException();
+        return env.Null();
+      }
+    }
+
+    if (options.Get("fetchMode").IsNumber()) {
+      fetchMode = options.Get("fetchMode").As<Napi::Number>().Int32Value();
+    }
+  }
+
+  std::vector<BatchStatement> statements;
+
+  if (!GetBatchStatements(env, info[0].As<Napi::Array>(), fetchMode, &statements)) {
+    return env.Null();
+  }
+
+  Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(info.Env());
+
+  BatchAsyncWorker *worker = new BatchAsyncWorker(this, statements, isolation, deferred);
+  worker->Queue(this->executor);
+
+  return deferred.Promise();
+}
+
+/******************************************************************************
+ ***************************** CACHE STATEMENTS *******************************
+ *****************************************************************************/
+
+// CacheStatementsAsyncWorker, used by CacheStatements function (see below)
+class CacheStatementsAsyncWorker : public DeferredAsyncWorker {
+
+  public:
+    CacheStatementsAsyncWorker(ODBCConnection *odbcConnectionObject, std::vector<SQLTCHAR*> statements, Napi::Promise::Deferred deferred)
+    : DeferredAsyncWorker(deferred), odbcConnectionObject(odbcConnectionObject), statements(statements), prepared(0) {}
+
+    ~CacheStatementsAsyncWorker() {
+      for (size_t i = 0; i < statements.size(); i++) {
+        free(statements[i]);
+      }
+    }
+
+    void Execute() {
+
+      DEBUG_PRINTF("ODBCConnection::CacheStatementsAsyncWorker::Execute\n");
+
+      for (size_t i = 0; i < statements.size(); i++) {
+
+        SQLHSTMT hSTMT = SQL_NULL_HSTMT;
+
+        sqlReturnCode = odbcConnectionObject->statementCache->Acquire(statements[i], &hSTMT);
+
+        if (!SQL_SUCCEEDED(sqlReturnCode)) {
+          // read the diagnostics before the handle goes back for reuse
+          if (hSTMT != SQL_NULL_HSTMT) {
+            CaptureSQLError(SQL_HANDLE_STMT, hSTMT, &errors);
+          } else {
+            CaptureSQLError(SQL_HANDLE_DBC, odbcConnectionObject->m_hDBC, &errors);
+          }
+        }
+
+        // the prepared handle stays in the cache, idle, for the first query
+        // that runs the same SQL
+        odbcConnectionObject->statementCache->Release(hSTMT);
+
+        if (!SQL_SUCCEEDED(sqlReturnCode)) {
+          failedIndex = i;
+          SetError("ERROR");
+          return;
+        }
+
+        prepared++;
+      }
+    }
+
+    void OnOK() {
+
+      Napi::Env env = Env();
+      Napi::HandleScope scope(env);
+
+      Resolve(Napi::Number::New(env, prepared));
+    }
+
+    void OnError(const Napi::Error &e) {
+
+      Napi::Env env = Env();
+      Napi::HandleScope scope(env);
+
+      Napi::Object error = GetSQLError(env, &errors,
+            (char *) "[node-odbc] Error in ODBCConnection::CacheStatementsAsyncWorker");
+      error.Set("index", Napi::Number::New(env, failedIndex));
+
+      Reject(error);
+    }
+
+  private:
+    ODBCConnection *odbcConnectionObject;
+    std::vector<SQLTCHAR*> statements;
+    std::vector<DiagnosticRecord> errors;
+    size_t prepared;
+    size_t failedIndex;
+    SQLRETURN sqlReturnCode;
+};
+
+/*
+ *  ODBCConnection::CacheStatements
+ *
+ *    Description: Prepares a list of statements into the connection's
+ *                 prepared statement cache without running them, so that the
+ *                 first queries after opening a connection don't pay for
+ *                 SQLPrepare. Statements that don't fit the cache's
+ *                 statementCacheSize are evicted again, least recently used
+ *                 first.
+ *
+ *    Parameters:
+ *      const Napi::CallbackInfo& info:
+ *        The information passed from the JavaSript environment, including the
+ *        function arguments for 'cacheStatements'.
+ *
+ *        info[0]: Array: SQL strings
+ *
+ *    Return:
+ *      Napi::Value:
+ *        A Promise that resolves to the number of statements prepared. A
+ *        rejection has 'index' set to the statement that failed to prepare.
+ */
+Napi::Value ODBCConnection::CacheStatements(const Napi::CallbackInfo& info) {
+
+  DEBUG_PRINTF("ODBCConnection::CacheStatements\n");
+
+  Napi::Env env = info.Env();
+  Napi::HandleScope scope(env);
+
+  if (info.Length() < 1 || !info[0].IsArray()) {
+    Napi::TypeError::New(env, "cacheStatements() takes an Array of SQL strings").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  Napi::Array array = info[0].As<Napi::Array>();
+  std::vector<SQLTCHAR*> statements;
+
+  for (uint32_t i = 0; i < array.Length(); i++) {
+    statements.push_back(NapiStringToSQLTCHAR(array.Get(i).ToString()));
+  }
+
+  Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(info.Env());
+
+  CacheStatementsAsyncWorker *worker = new CacheStatementsAsyncWorker(this, statements, deferred);
+  worker->Queue(this->executor);
+
+  return deferred.Promise();
+}
+
+/******************************************************************************
+ ******************************** GET INFO ************************************
+ *****************************************************************************/
+
+// GetInfoAsyncWorker, used by GetInfo function (see below)
+class GetInfoAsyncWorker : public DeferredAsyncWorker {
+
+  public:
+    GetInfoAsyncWorker(ODBCConnection *odbcConnectionObject, SQLUSMALLINT infoType, Napi::Promise::Deferred deferred)
+    : DeferredAsyncWorker(deferred), odbcConnectionObject(odbcConnectionObject), infoType(infoType) {}
+
+    ~GetInfoAsyncWorker() {}
+
+    void Execute() {
+
+      DEBUG_PRINTF("ODBCConnection::GetInfoAsyncWorker:Execute");
+
+      switch (infoType) {
+        case SQL_USER_NAME:
+
+          sqlReturnCode = SQLGetInfo(odbcConnectionObject->m_hDBC, SQL_USER_NAME, userName, sizeof(userName), &userNameLength);
+
+          if (SQL_SUCCEEDED(sqlReturnCode)) {
+           return;
+          } else {
+            SetError("Error");
+          }
+
+        default:
+          SetError("Error");
+      }
+    }
+
+    void OnOK() {
+
+      Napi::Env env = Env();
+      Napi::HandleScope scope(env);
+
+      Napi::Value res;
+
+      #ifdef UNICODE
+        res = Napi::String::New(env, (const char16_t *)userName);
+      #else
+        res = Napi::String::New(env, (const char *) userName);
+      #endif
+
+      Resolve(res);
+    }
+
+    void OnError(const Napi::Error &e) {
+
+      Napi::Env env = Env();
+      Napi::HandleScope scope(env);
+
+      Reject(GetSQLError(env, SQL_HANDLE_DBC, odbcConnectionObject->m_hDBC,
+            (char *) "[node-odbc] Error in ODBCConnection::GetInfoAsyncWorker"));
+    }
+
+  private:
+    ODBCConnection *odbcConnectionObject;
+    SQLUSMALLINT infoType;
+    SQLTCHAR userName[255];
+    SQLSMALLINT userNameLength;
+    SQLRETURN sqlReturnCode;
+};
+
+/*
+ *  ODBCConnection::GetInfo
+ *
+ *    Description: Returns the info requested from the connection.
+ *
+ *    Parameters:
+ *      const Napi::CallbackInfo& info:
+ *        The information passed from the JavaSript environment, including the
+ *        function arguments for 'getInfo'.
+ *
+ *        info[0]: Number: option
+ *        info[4]: Function: callback function:
+ *            function(error, result)
+ *              error: An error object if the connection was not opened, or
+ *                     null if operation was successful.
+ *              result: A string containing the info requested.
+ *
+ *    Return:
+ *      Napi::Value:
+ *        Undefined (results returned in callback)
+ */
+Napi::Value ODBCConnection::GetInfo(const Napi::CallbackInfo& info) {
+
+  DEBUG_PRINTF("ODBCConnection::GetInfo\n");
+
+  Napi::Env env = info.Env();
+  Napi::HandleScope scope(env);
+
+  if ( !info[0].IsNumber() ) {
+    Napi::TypeError::New(env, "ODBCConnection::GetInfo(): Argument 0 must be a Number.").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  SQLUSMALLINT infoType = info[0].As<Napi::Number>().Int32Value();
 
   Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(info.Env());
 
   GetInfoAsyncWorker *worker = new GetInfoAsyncWorker(this, infoType, deferred);
-  worker->Queue();
+  worker->Queue(this->executor);
+
+  return deferred.Promise();
+}
+
+/******************************************************************************
+ ********************************* IS ALIVE ***********************************
+ *****************************************************************************/
+
+// IsAliveAsyncWorker, used by IsAlive function (see below)
+class IsAliveAsyncWorker : public DeferredAsyncWorker {
+
+  public:
+    IsAliveAsyncWorker(ODBCConnection *odbcConnectionObject, SQLTCHAR *probe, Napi::Promise::Deferred deferred)
+    : DeferredAsyncWorker(deferred), odbcConnectionObject(odbcConnectionObject), probe(probe), alive(false) {}
+
+    ~IsAliveAsyncWorker() {
+      free(probe);
+    }
+
+    void Execute() {
+
+      DEBUG_PRINTF("ODBCConnection::IsAliveAsyncWorker::Execute\n");
+
+      // the driver's own view of the connection, no round trip to the server
+      SQLUINTEGER dead = SQL_CD_TRUE;
+
+      sqlReturnCode = SQLGetConnectAttr(
+        odbcConnectionObject->m_hDBC, // ConnectionHandle
+        SQL_ATTR_CONNECTION_DEAD,     // Attribute
+        &dead,                        // ValuePtr
+        SQL_IS_UINTEGER,              // BufferLength
+        NULL);                        // StringLengthPtr
+
+      if (SQL_SUCCEEDED(sqlReturnCode)) {
+        alive = dead == SQL_CD_FALSE;
+        return;
+      }
+
+      // drivers older than ODBC 3.5 don't know the attribute; run the probe
+      SQLHSTMT hSTMT = SQL_NULL_HSTMT;
+
+      sqlReturnCode = odbcConnectionObject->statementPool->Checkout(&hSTMT);
+
+      if (!SQL_SUCCEEDED(sqlReturnCode)) {
+        return;
+      }
+
+      sqlReturnCode = SQLExecDirect(hSTMT, probe, SQL_NTS);
+
+      alive = SQL_SUCCEEDED(sqlReturnCode) || sqlReturnCode == SQL_NO_DATA;
+
+      if (alive) {
+        odbcConnectionObject->statementPool->Return(hSTMT);
+      } else {
+        odbcConnectionObject->statementPool->Free(hSTMT);
+      }
+    }
+
+    void OnOK() {
+
+      Napi::Env env = Env();
+      Napi::HandleScope scope(env);
+
+      Resolve(Napi::Boolean::New(env, alive));
+    }
+
+  private:
+    ODBCConnection *odbcConnectionObject;
+    SQLTCHAR *probe;
+    bool alive;
+    SQLRETURN sqlReturnCode;
+};
+
+/*
+ *  ODBCConnection::IsAlive
+ *
+ *    Description: Checks whether the connection is still usable. Reads
+ *                 SQL_ATTR_CONNECTION_DEAD, which the driver answers without
+ *                 going to the server; if the driver doesn't support it, a
+ *                 probe statement is run instead.
+ *
+ *    Parameters:
+ *      const Napi::CallbackInfo& info:
+ *        The information passed from the JavaSript environment, including the
+ *        function arguments for 'isAlive'.
+ *
+ *        info[0?]: String: the probe statement (default 'SELECT 1')
+ *
+ *    Return:
+ *      Napi::Value:
+ *        A Promise that resolves to true or false; it is never rejected.
+ */
+Napi::Value ODBCConnection::IsAlive(const Napi::CallbackInfo& info) {
+
+  DEBUG_PRINTF("ODBCConnection::IsAlive\n");
+
+  Napi::Env env = info.Env();
+  Napi::HandleScope scope(env);
+
+  Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(info.Env());
+
+  if (!this->connected || this->m_hDBC == NULL) {
+    deferred.Resolve(Napi::Boolean::New(env, false));
+    return deferred.Promise();
+  }
+
+  Napi::String probe = Napi::String::New(env, "SELECT 1");
+
+  if (info.Length() > 0 && info[0].IsString()) {
+    probe = info[0].As<Napi::String>();
+  }
+
+  IsAliveAsyncWorker *worker = new IsAliveAsyncWorker(this, NapiStringToSQLTCHAR(probe), deferred);
+  worker->Queue(this->executor);
+
+  return deferred.Promise();
+}
+
+/******************************************************************************
+ ********************************** RESET *************************************
+ *****************************************************************************/
+
+// ResetAsyncWorker, used by Reset function (see below)
+class ResetAsyncWorker : public DeferredAsyncWorker {
+
+  public:
+    ResetAsyncWorker(ODBCConnection *odbcConnectionObject, Napi::Promise::Deferred deferred)
+    : DeferredAsyncWorker(deferred), odbcConnectionObject(odbcConnectionObject), statementsOpen(0) {}
+
+    ~ResetAsyncWorker() {}
+
+    void Execute() {
+
+      DEBUG_PRINTF("ODBCConnection::ResetAsyncWorker::Execute\n");
+
+      SQLHDBC hDBC = odbcConnectionObject->m_hDBC;
+
+      // statements and results nobody closed; their cursors are left to
+      // whoever holds them, closing them here could race with a worker
+      // still executing or fetching on them
+      statementsOpen = odbcConnectionObject->statementPool->CheckedOut();
+
+      odbcConnectionObject->connectionLock->Lock();
+
+      // harmless in autocommit mode, where there is nothing to roll back
+      sqlReturnCode = SQLEndTran(SQL_HANDLE_DBC, hDBC, SQL_ROLLBACK);
+
+      if (SQL_SUCCEEDED(sqlReturnCode)) {
+        sqlReturnCode = SQLSetConnectAttr(hDBC, SQL_ATTR_AUTOCOMMIT, (SQLPOINTER) SQL_AUTOCOMMIT_ON, SQL_NTS);
+      }
+
+      if (SQL_SUCCEEDED(sqlReturnCode) && odbcConnectionObject->initialIsolation != 0) {
+        sqlReturnCode = SQLSetConnectAttr(hDBC, SQL_ATTR_TXN_ISOLATION,
+          (SQLPOINTER)(uintptr_t) odbcConnectionObject->initialIsolation, SQL_IS_UINTEGER);
+      }
+
+      if (SQL_SUCCEEDED(sqlReturnCode) && odbcConnectionObject->initialAccessMode >= 0) {
+        sqlReturnCode = SQLSetConnectAttr(hDBC, SQL_ATTR_ACCESS_MODE,
+          (SQLPOINTER)(uintptr_t) odbcConnectionObject->initialAccessMode, SQL_IS_UINTEGER);
+      }
+
+      if (SQL_SUCCEEDED(sqlReturnCode) && odbcConnectionObject->initialCatalog[0] != 0) {
+        sqlReturnCode = SQLSetConnectAttr(hDBC, SQL_ATTR_CURRENT_CATALOG,
+          (SQLPOINTER) odbcConnectionObject->initialCatalog, SQL_NTS);
+      }
+
+      if (!SQL_SUCCEEDED(sqlReturnCode)) {
+        CaptureSQLError(SQL_HANDLE_DBC, hDBC, &errors);
+        SetError("ERROR");
+      }
+
+      odbcConnectionObject->connectionLock->Unlock();
+    }
+
+    void OnOK() {
+
+      Napi::Env env = Env();
+      Napi::HandleScope scope(env);
+
+      Resolve(Napi::Number::New(env, statementsOpen));
+    }
+
+    void OnError(const Napi::Error &e) {
+
+      Napi::Env env = Env();
+      Napi::HandleScope scope(env);
+
+      Reject(GetSQLError(env, &errors, (char *) "[node-odbc] Error in ODBCConnection::ResetAsyncWorker"));
+    }
+
+  private:
+    ODBCConnection *odbcConnectionObject;
+    std::vector<DiagnosticRecord> errors;
+    size_t statementsOpen;
+    SQLRETURN sqlReturnCode;
+};
+
+/*
+ *  ODBCConnection::Reset
+ *
+ *    Description: Puts the session back into the state it was in right after
+ *                 it was opened, without logging in again: rolls back any
+ *                 open transaction, turns autocommit back on, and restores
+ *                 the transaction isolation level, the access mode and the
+ *                 current catalog. Statements and results that are still
+ *                 open are not touched.
+ *
+ *    Parameters:
+ *      const Napi::CallbackInfo& info:
+ *        The information passed from the JavaSript environment, including the
+ *        function arguments for 'reset'.
+ *
+ *    Return:
+ *      Napi::Value:
+ *        A Promise that resolves to the number of statement handles that were
+ *        still checked out (including prepared statements in the cache).
+ */
+Napi::Value ODBCConnection::Reset(const Napi::CallbackInfo& info) {
+
+  DEBUG_PRINTF("ODBCConnection::Reset\n");
+
+  Napi::Env env = info.Env();
+  Napi::HandleScope scope(env);
+
+  Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(info.Env());
+
+  if (!this->connected || this->m_hDBC == NULL) {
+    deferred.Reject(Napi::Error::New(env, "[node-odbc] Connection is not open").Value());
+    return deferred.Promise();
+  }
+
+  ResetAsyncWorker *worker = new ResetAsyncWorker(this, deferred);
+  worker->Queue(this->executor);
 
   return deferred.Promise();
 }
@@ -796,9 +2196,12 @@ class TablesAsyncWorker : public DeferredAsyncWorker {
 
     void Execute() {
 
-      uv_mutex_lock(&ODBC::g_odbcMutex);
-      SQLAllocHandle(SQL_HANDLE_STMT, odbcConnectionObject->m_hDBC, &data->hSTMT );
-      uv_mutex_unlock(&ODBC::g_odbcMutex);
+      data->sqlReturnCode = data->statementPool->Checkout(&data->hSTMT);
+
+      if (!SQL_SUCCEEDED(data->sqlReturnCode)) {
+        SetError("ERROR");
+        return;
+      }
 
       data->sqlReturnCode = SQLTables(
         data->hSTMT,
@@ -856,6 +2259,8 @@ class TablesAsyncWorker : public DeferredAsyncWorker {
 
       Reject(GetSQLError(env, SQL_HANDLE_DBC, odbcConnectionObject->m_hDBC,
             (char *) "[node-odbc] Error in ODBCConnection::TablesAsyncWorker"));
+
+      ReleaseStatement(data);
     }
 
   private:
@@ -905,6 +2310,8 @@ Napi::Value ODBCConnection::Tables(const Napi::CallbackInfo& info) {
   Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(info.Env());
 
   QueryData* data = new QueryData();
+  data->executor = this->executor;
+  data->connectionLock = this->connectionLock;
 
   // Napi doesn't have LowMemoryNotification like NAN did. Throw standard error.
   if (!data) {
@@ -917,8 +2324,10 @@ Napi::Value ODBCConnection::Tables(const Napi::CallbackInfo& info) {
   if (!table.IsNull()) { data->table = NapiStringToSQLTCHAR(table); }
   if (!type.IsNull()) { data->type = NapiStringToSQLTCHAR(type); }
 
+  data->statementPool = this->statementPool;
+
   TablesAsyncWorker *worker = new TablesAsyncWorker(this, data, deferred);
-  worker->Queue();
+  worker->Queue(this->executor);
 
   return deferred.Promise();
 }
@@ -939,11 +2348,12 @@ class ColumnsAsyncWorker : public DeferredAsyncWorker {
 
     void Execute() {
 
-      uv_mutex_lock(&ODBC::g_odbcMutex);
+      data->sqlReturnCode = data->statementPool->Checkout(&data->hSTMT);
 
-      SQLAllocHandle(SQL_HANDLE_STMT, odbcConnectionObject->m_hDBC, &data->hSTMT );
-
-      uv_mutex_unlock(&ODBC::g_odbcMutex);
+      if (!SQL_SUCCEEDED(data->sqlReturnCode)) {
+        SetError("ERROR");
+        return;
+      }
 
       data->sqlReturnCode = SQLColumns(
         data->hSTMT,
@@ -980,8 +2390,8 @@ class ColumnsAsyncWorker : public DeferredAsyncWorker {
       // no result object should be created, just return with true instead
       if (data->noResultObject) {
 
-        //free the handle
-        data->sqlReturnCode = SQLFreeHandle(SQL_HANDLE_STMT, data->hSTMT);
+        //give the handle back to the pool
+        ReleaseStatement(data);
 
         Resolve(Napi::Boolean::New(env, true));
 
@@ -1010,6 +2420,8 @@ class ColumnsAsyncWorker : public DeferredAsyncWorker {
 
       Reject(GetSQLError(env, SQL_HANDLE_STMT, data->hSTMT,
             (char *) "[node-odbc] Error in ODBCConnection::ColumnsAsyncWorker"));
+
+      ReleaseStatement(data);
     }
 
   private:
@@ -1053,6 +2465,8 @@ Napi::Value ODBCConnection::Columns(const Napi::CallbackInfo& info) {
   REQ_STRO_OR_NULL_ARG(3, type);
 
   QueryData* data = new QueryData;
+  data->executor = this->executor;
+  data->connectionLock = this->connectionLock;
 
   // Napi doesn't have LowMemoryNotification like NAN did. Throw standard error.
   if (!data) {
@@ -1065,10 +2479,12 @@ Napi::Value ODBCConnection::Columns(const Napi::CallbackInfo& info) {
   if (!table.IsNull()) { data->table = NapiStringToSQLTCHAR(table); }
   if (!type.IsNull()) { data->type = NapiStringToSQLTCHAR(type); }
 
+  data->statementPool = this->statementPool;
+
   Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(info.Env());
 
   ColumnsAsyncWorker *worker = new ColumnsAsyncWorker(this, data, deferred);
-  worker->Queue();
+  worker->Queue(this->executor);
 
   return deferred.Promise();
 }
@@ -1147,7 +2563,7 @@ Napi::Value ODBCConnection::BeginTransaction(const Napi::CallbackInfo& info) {
   Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(info.Env());
 
   BeginTransactionAsyncWorker *worker = new BeginTransactionAsyncWorker(this, deferred);
-  worker->Queue();
+  worker->Queue(this->executor);
 
   return deferred.Promise();
 }
@@ -1240,7 +2656,7 @@ Napi::Value ODBCConnection::EndTransaction(const Napi::CallbackInfo& info) {
   Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(info.Env());
 
   EndTransactionAsyncWorker *worker = new EndTransactionAsyncWorker(this, completionType, deferred);
-  worker->Queue();
+  worker->Queue(this->executor);
 
   return deferred.Promise();
 }
@@ -20,6 +20,15 @@
 
 #include "declarations.h"
 #include "odbc.h"
+#include "statement_cache.h"
+#include "statement_pool.h"
+#include "async_execution.h"
+#include "query_canceller.h"
+#include "executor.h"
+#include "handle_lock.h"
+#include "environment.h"
+
+struct BatchStatement;
 
 class ODBCConnection : public Napi::ObjectWrap<ODBCConnection> {
 
@@ -27,11 +36,16 @@ class ODBCConnection : public Napi::ObjectWrap<ODBCConnection> {
   friend class CloseAsyncWorker;
   friend class CreateStatementAsyncWorker;
   friend class QueryAsyncWorker;
+  friend class QueryAllAsyncWorker;
+  friend class BatchAsyncWorker;
+  friend class CacheStatementsAsyncWorker;
   friend class BeginTransactionAsyncWorker;
   friend class EndTransactionAsyncWorker;
   friend class TablesAsyncWorker;
   friend class ColumnsAsyncWorker;
   friend class GetInfoAsyncWorker;
+  friend class IsAliveAsyncWorker;
+  friend class ResetAsyncWorker;
 
   public:
 
@@ -52,11 +66,17 @@ class ODBCConnection : public Napi::ObjectWrap<ODBCConnection> {
     Napi::Value Close(const Napi::CallbackInfo& info);
     Napi::Value CreateStatement(const Napi::CallbackInfo& info);
     Napi::Value Query(const Napi::CallbackInfo& info);
+    Napi::Value QueryAll(const Napi::CallbackInfo& info);
+    Napi::Value Batch(const Napi::CallbackInfo& info);
+    Napi::Value Transaction(const Napi::CallbackInfo& info);
+    Napi::Value CacheStatements(const Napi::CallbackInfo& info);
     Napi::Value BeginTransaction(const Napi::CallbackInfo& info);
     Napi::Value EndTransaction(const Napi::CallbackInfo& info);
     Napi::Value Columns(const Napi::CallbackInfo& info);
     Napi::Value Tables(const Napi::CallbackInfo& info);
     Napi::Value GetInfo(const Napi::CallbackInfo& info);
+    Napi::Value IsAlive(const Napi::CallbackInfo& info);
+    Napi::Value Reset(const Napi::CallbackInfo& info);
 
     //Property Getter/Setters
     Napi::Value ConnectedGetter(const Napi::CallbackInfo& info);
@@ -67,8 +87,36 @@ class ODBCConnection : public Napi::ObjectWrap<ODBCConnection> {
     Napi::Value LoginTimeoutGetter(const Napi::CallbackInfo& info);
     void LoginTimeoutSetter(const Napi::CallbackInfo& info, const Napi::Value &value);
 
+    Napi::Value StatementCacheSizeGetter(const Napi::CallbackInfo& info);
+    void StatementCacheSizeSetter(const Napi::CallbackInfo& info, const Napi::Value &value);
+
+    Napi::Value StatementCacheStatsGetter(const Napi::CallbackInfo& info);
+
+    Napi::Value StatementPoolSizeGetter(const Napi::CallbackInfo& info);
+    void StatementPoolSizeSetter(const Napi::CallbackInfo& info, const Napi::Value &value);
+
+    Napi::Value StatementPoolStatsGetter(const Napi::CallbackInfo& info);
+
+    Napi::Value AsyncExecutionGetter(const Napi::CallbackInfo& info);
+    void AsyncExecutionSetter(const Napi::CallbackInfo& info, const Napi::Value &value);
+
+    Napi::Value DedicatedThreadGetter(const Napi::CallbackInfo& info);
+
+    Napi::Value ReadOnlyGetter(const Napi::CallbackInfo& info);
+    void ReadOnlySetter(const Napi::CallbackInfo& info, const Napi::Value &value);
+
+    Napi::Value LockStatsGetter(const Napi::CallbackInfo& info);
+
+    Napi::Value CapabilitiesGetter(const Napi::CallbackInfo& info);
+
   protected:
 
+    // fills capabilities, on the worker thread that just logged in
+    void ReadCapabilities();
+
+    bool GetBatchStatements(Napi::Env env, Napi::Array array, int fetchMode, std::vector<BatchStatement> *statements);
+    bool StartAsyncExecution(QueryData *data, Napi::Promise::Deferred deferred, AsyncExecution::Callback onComplete);
+
     SQLHENV m_hENV;
     SQLHDBC m_hDBC;
     SQLUSMALLINT canHaveMoreResults;
@@ -76,6 +124,30 @@ class ODBCConnection : public Napi::ObjectWrap<ODBCConnection> {
     int statements;
     SQLUINTEGER connectTimeout;
     SQLUINTEGER loginTimeout;
+    std::shared_ptr<StatementPool> statementPool;
+    std::shared_ptr<StatementCache> statementCache;
+    bool asyncExecution;
+    bool asyncExecutionSupported;
+    bool readOnly;
+
+    // session defaults read right after login, restored by reset();
+    // 0, -1 and an empty string when the driver couldn't tell
+    SQLUINTEGER initialIsolation;
+    SQLINTEGER initialAccessMode;
+    SQLTCHAR initialCatalog[256];
+
+    Capabilities capabilities;
+
+    bool dedicatedThread;
+    std::shared_ptr<Executor> executor;
+
+    // keeps the environment handle alive until m_hDBC has been freed
+    std::shared_ptr<Environment> environment;
+
+    // environmentLock guards m_hDBC's allocation and release, connectionLock
+    // the login, connection attributes and statement handles
+    std::shared_ptr<HandleLock> environmentLock;
+    std::shared_ptr<HandleLock> connectionLock;
 };
 
 #endif
@@ -22,11 +22,6 @@
 Napi::FunctionReference ODBCResult::constructor;
 Napi::String ODBCResult::OPTION_FETCH_MODE;
 
-HENV ODBCResult::m_hENV;
-HDBC ODBCResult::m_hDBC;
-HSTMT ODBCResult::m_hSTMT;
-bool ODBCResult::m_canFreeHandle;
-
 int fetchMode;
 
 Napi::Object ODBCResult::Init(Napi::Env env, Napi::Object exports) {
@@ -45,7 +40,8 @@ Napi::Object ODBCResult::Init(Napi::Env env, Napi::Object exports) {
 
     InstanceMethod("close", &ODBCResult::Close),
 
-    InstanceAccessor("fetchMode", &ODBCResult::FetchModeGetter, &ODBCResult::FetchModeSetter)
+    InstanceAccessor("fetchMode", &ODBCResult::FetchModeGetter, &ODBCResult::FetchModeSetter),
+    InstanceAccessor("timings", &ODBCResult::TimingsGetter, nullptr)
   });
 
   // Attach the Database Constructor to the target object
@@ -94,10 +90,9 @@ SQLRETURN ODBCResult::Free() {
   SQLRETURN sqlReturnCode = SQL_SUCCESS;
 
   if (this->m_hSTMT && this->m_canFreeHandle) {
-    uv_mutex_lock(&ODBC::g_odbcMutex);
-    sqlReturnCode = SQLFreeHandle(SQL_HANDLE_STMT, this->m_hSTMT);
+    // back to the statement cache or pool it came from, or freed
+    sqlReturnCode = ReleaseStatement(this->data);
     this->m_hSTMT = NULL;
-    uv_mutex_unlock(&ODBC::g_odbcMutex);
   }
 
   return sqlReturnCode;
@@ -121,6 +116,17 @@ void ODBCResult::FetchModeSetter(const Napi::CallbackInfo& info, const Napi::Val
   }
 }
 
+// where the time went, in milliseconds since the query was queued: on the
+// thread pool (started), getting a handle (allocated), in the driver
+// (executed), binding (bound), fetching and turning rows into values
+Napi::Value ODBCResult::TimingsGetter(const Napi::CallbackInfo& info) {
+
+  Napi::Env env = info.Env();
+  Napi::HandleScope scope(env);
+
+  return GetQueryTimings(env, this->data);
+}
+
 
 /******************************************************************************
  ********************************** FETCH *************************************
@@ -131,7 +137,9 @@ class FetchAsyncWorker : public DeferredAsyncWorker {
 
   public:
     FetchAsyncWorker(ODBCResult *odbcResultObject, QueryData *data, Napi::Promise::Deferred deferred)
-    : DeferredAsyncWorker(deferred), odbcResultObject(odbcResultObject), data(data) {}
+    : DeferredAsyncWorker(deferred), odbcResultObject(odbcResultObject), data(data) {
+      Measure(Metrics::FETCH);
+    }
 
     ~FetchAsyncWorker() {}
 
@@ -217,7 +225,7 @@ Napi::Value ODBCResult::Fetch(const Napi::CallbackInfo& info) {
   Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(info.Env());
 
   FetchAsyncWorker *worker = new FetchAsyncWorker(this, this->data, deferred);
-  worker->Queue();
+  worker->Queue(this->data->executor);
 
   return deferred.Promise();
 }
@@ -232,12 +240,16 @@ class FetchAllAsyncWorker : public DeferredAsyncWorker {
 
   public:
     FetchAllAsyncWorker(ODBCResult *odbcResultObject, QueryData *data, Napi::Promise::Deferred deferred)
-    : DeferredAsyncWorker(deferred), odbcResultObject(odbcResultObject), data(data) {}
+    : DeferredAsyncWorker(deferred), odbcResultObject(odbcResultObject), data(data) {
+      Measure(Metrics::FETCH);
+    }
 
     ~FetchAllAsyncWorker() {}
 
     void Execute() {
 
+      data->timings.fetchStarted = uv_hrtime();
+
       //Only loop through the recordset if there are columns
       if (data->columnCount > 0) {
         FetchAllData(data);
@@ -259,6 +271,7 @@ class FetchAllAsyncWorker : public DeferredAsyncWorker {
       Napi::HandleScope scope(env);
 
       Napi::Array rows = GetNapiRowData(env, &(data->storedRows), data->columns, data->columnCount, odbcResultObject->fetchMode);
+      data->timings.materialized = uv_hrtime();
 
       Resolve(rows);
     }
@@ -268,7 +281,10 @@ class FetchAllAsyncWorker : public DeferredAsyncWorker {
       Napi::Env env = Env();
       Napi::HandleScope scope(env);
 
-      Reject(GetSQLError(env, SQL_HANDLE_STMT, data->hSTMT));
+      Napi::Object error = GetSQLError(env, SQL_HANDLE_STMT, data->hSTMT);
+      error.Set(Napi::String::New(env, "timings"), GetQueryTimings(env, data));
+
+      Reject(error);
     }
 
   private:
@@ -315,8 +331,10 @@ Napi::Value ODBCResult::FetchAll(const Napi::CallbackInfo& info) {
 
   Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(info.Env());
 
+  this->data->timings.fetchQueued = uv_hrtime();
+
   FetchAllAsyncWorker *worker = new FetchAllAsyncWorker(this, this->data, deferred);
-  worker->Queue();
+  worker->Queue(this->data->executor);
 
   return deferred.Promise();
 }
@@ -443,7 +461,9 @@ class CloseAsyncWorker : public DeferredAsyncWorker {
 
   public:
     CloseAsyncWorker(ODBCResult *odbcResultObject, int closeOption, Napi::Promise::Deferred deferred)
-    : DeferredAsyncWorker(deferred), closeOption(closeOption), odbcResultObject(odbcResultObject) {}
+    : DeferredAsyncWorker(deferred), closeOption(closeOption), odbcResultObject(odbcResultObject) {
+      Measure(Metrics::CLOSE);
+    }
 
     ~CloseAsyncWorker() {}
 
@@ -452,17 +472,17 @@ class CloseAsyncWorker : public DeferredAsyncWorker {
       DEBUG_PRINTF("ODBCResult::CloseAsyncWorker::Execute\n");
 
       if (closeOption == SQL_DESTROY && odbcResultObject->m_canFreeHandle) {
-        odbcResultObject->Free();
+        sqlReturnCode = odbcResultObject->Free();
       } else if (closeOption == SQL_DESTROY && !odbcResultObject->m_canFreeHandle) {
         //We technically can't free the handle so, we'll SQL_CLOSE
-        uv_mutex_lock(&ODBC::g_odbcMutex);
+        odbcResultObject->data->connectionLock->Lock();
         sqlReturnCode = SQLFreeStmt(odbcResultObject->m_hSTMT, SQL_CLOSE);
-        uv_mutex_unlock(&ODBC::g_odbcMutex);
+        odbcResultObject->data->connectionLock->Unlock();
       }
       else {
-        uv_mutex_lock(&ODBC::g_odbcMutex);
+        odbcResultObject->data->connectionLock->Lock();
         sqlReturnCode = SQLFreeStmt(odbcResultObject->m_hSTMT, closeOption);
-        uv_mutex_unlock(&ODBC::g_odbcMutex);
+        odbcResultObject->data->connectionLock->Unlock();
       }
 
       if (SQL_SUCCEEDED(sqlReturnCode)) {
@@ -523,7 +543,7 @@ Napi::Value ODBCResult::Close(const Napi::CallbackInfo& info) {
   Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(info.Env());
 
   CloseAsyncWorker *worker = new CloseAsyncWorker(this, closeOption, deferred);
-  worker->Queue();
+  worker->Queue(this->data->executor);
 
   return deferred.Promise();
 }
@@ -35,10 +35,10 @@ class ODBCResult : public Napi::ObjectWrap<ODBCResult> {
 
     QueryData *data;
 
-    static HENV m_hENV;
-    static HDBC m_hDBC;
-    static HSTMT m_hSTMT;
-    static bool m_canFreeHandle;
+    HENV m_hENV;
+    HDBC m_hDBC;
+    HSTMT m_hSTMT;
+    bool m_canFreeHandle;
 
     int fetchMode;
 
@@ -56,6 +56,8 @@ class ODBCResult : public Napi::ObjectWrap<ODBCResult> {
     //property getter/setters
     Napi::Value FetchModeGetter(const Napi::CallbackInfo& info);
     void FetchModeSetter(const Napi::CallbackInfo& info, const Napi::Value& value);
+
+    Napi::Value TimingsGetter(const Napi::CallbackInfo& info);
 };
 
 #endif
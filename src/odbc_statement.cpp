@@ -29,10 +29,6 @@
 
 Napi::FunctionReference ODBCStatement::constructor;
 
-HENV ODBCStatement::m_hENV;
-HDBC ODBCStatement::m_hDBC;
-HSTMT ODBCStatement::m_hSTMT;
-
 Napi::Object ODBCStatement::Init(Napi::Env env, Napi::Object exports) {
 
   DEBUG_PRINTF("ODBCStatement::Init\n");
@@ -46,6 +42,7 @@ Napi::Object ODBCStatement::Init(Napi::Env env, Napi::Object exports) {
     InstanceMethod("prepare", &ODBCStatement::Prepare),
     InstanceMethod("bind", &ODBCStatement::Bind),
     InstanceMethod("execute", &ODBCStatement::Execute),
+    InstanceMethod("executeMany", &ODBCStatement::ExecuteMany),
     InstanceMethod("close", &ODBCStatement::Close)
   });
 
@@ -65,6 +62,19 @@ ODBCStatement::ODBCStatement(const Napi::CallbackInfo& info) : Napi::ObjectWrap<
   this->m_hENV = *(info[0].As<Napi::External<SQLHENV>>().Data());
   this->m_hDBC = *(info[1].As<Napi::External<SQLHDBC>>().Data());
   this->data->hSTMT = *(info[2].As<Napi::External<SQLHSTMT>>().Data());
+  this->m_hSTMT = this->data->hSTMT;
+
+  if (info.Length() > 3 && info[3].IsExternal()) {
+    this->statementPool = *(info[3].As<Napi::External<std::shared_ptr<StatementPool>>>().Data());
+  }
+
+  if (info.Length() > 4 && info[4].IsExternal()) {
+    this->data->executor = *(info[4].As<Napi::External<std::shared_ptr<Executor>>>().Data());
+  }
+
+  if (info.Length() > 5 && info[5].IsExternal()) {
+    this->data->connectionLock = *(info[5].As<Napi::External<std::shared_ptr<HandleLock>>>().Data());
+  }
 }
 
 ODBCStatement::~ODBCStatement() {
@@ -77,11 +87,15 @@ void ODBCStatement::Free() {
 
   // delete data;
 
-  if (m_hSTMT) {
-    uv_mutex_lock(&ODBC::g_odbcMutex);
+  if (m_hSTMT && statementPool) {
+    statementPool->Return(m_hSTMT);
+    statementPool.reset();
+    m_hSTMT = NULL;
+  } else if (m_hSTMT) {
+    data->connectionLock->Lock();
     SQLFreeHandle(SQL_HANDLE_STMT, m_hSTMT);
     m_hSTMT = NULL;
-    uv_mutex_unlock(&ODBC::g_odbcMutex);
+    data->connectionLock->Unlock();
   }
 }
 
@@ -94,7 +108,9 @@ class ExecuteNonQueryAsyncWorker : public DeferredAsyncWorker {
 
   public:
     ExecuteNonQueryAsyncWorker(ODBCStatement *odbcStatementObject, Napi::Promise::Deferred deferred)
-    :DeferredAsyncWorker(deferred), odbcStatementObject(odbcStatementObject), data(odbcStatementObject->data) {}
+    :DeferredAsyncWorker(deferred), odbcStatementObject(odbcStatementObject), data(odbcStatementObject->data) {
+      Measure(Metrics::EXECUTE);
+    }
 
     ~ExecuteNonQueryAsyncWorker() {}
 
@@ -103,6 +119,11 @@ class ExecuteNonQueryAsyncWorker : public DeferredAsyncWorker {
 
       data->sqlReturnCode = SQLExecute(data->hSTMT);
 
+      if (data->sqlReturnCode == SQL_NEED_DATA) {
+        // send the streamed parameters
+        data->sqlReturnCode = PutStreamedParameters(data);
+      }
+
       if (SQL_SUCCEEDED(data->sqlReturnCode)) {
 
       } else {
@@ -125,9 +146,9 @@ class ExecuteNonQueryAsyncWorker : public DeferredAsyncWorker {
         rowCount = 0;
       }
 
-      uv_mutex_lock(&ODBC::g_odbcMutex);
+      data->connectionLock->Lock();
       SQLFreeStmt(data->hSTMT, SQL_CLOSE);
-      uv_mutex_unlock(&ODBC::g_odbcMutex);
+      data->connectionLock->Unlock();
 
       Resolve(Napi::Number::New(env, rowCount));
     }
@@ -139,6 +160,14 @@ class ExecuteNonQueryAsyncWorker : public DeferredAsyncWorker {
       Napi::Env env = Env();
       Napi::HandleScope scope(env);
 
+      // a parameter stream that failed is reported with its own error
+      Napi::Value streamError = GetParameterStreamError(env, data);
+
+      if (!streamError.IsUndefined()) {
+        Reject(streamError);
+        return;
+      }
+
       Reject(GetSQLError(env, SQL_HANDLE_STMT, data->hSTMT,
             (char *) "[node-odbc] Error in ODBCStatement::ExecuteNonQueryAsyncWorker"));
 
@@ -178,7 +207,7 @@ Napi::Value ODBCStatement::ExecuteNonQuery(const Napi::CallbackInfo& info) {
   Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(info.Env());
 
   ExecuteNonQueryAsyncWorker *worker = new ExecuteNonQueryAsyncWorker(this, deferred);
-  worker->Queue();
+  worker->Queue(this->data->executor);
 
   return deferred.Promise();
 }
@@ -214,6 +243,11 @@ class ExecuteDirectAsyncWorker : public DeferredAsyncWorker {
         SQL_NTS
       );
 
+      if (data->sqlReturnCode == SQL_NEED_DATA) {
+        // send the streamed parameters
+        data->sqlReturnCode = PutStreamedParameters(data);
+      }
+
       if (SQL_SUCCEEDED(data->sqlReturnCode)) {
         BindColumns(data);
       } else {
@@ -258,6 +292,14 @@ class ExecuteDirectAsyncWorker : public DeferredAsyncWorker {
       Napi::Env env = Env();
       Napi::HandleScope scope(env);
 
+      // a parameter stream that failed is reported with its own error
+      Napi::Value streamError = GetParameterStreamError(env, data);
+
+      if (!streamError.IsUndefined()) {
+        Reject(streamError);
+        return;
+      }
+
       Reject(GetSQLError(env, SQL_HANDLE_STMT, data->hSTMT,
             (char *) "[node-odbc] Error in ODBCStatement::ExecuteDirectAsyncWorker"));
     }
@@ -301,7 +343,7 @@ Napi::Value ODBCStatement::ExecuteDirect(const Napi::CallbackInfo& info) {
   data->sql = NapiStringToSQLTCHAR(sql);
 
   ExecuteDirectAsyncWorker *worker = new ExecuteDirectAsyncWorker(this, deferred);
-  worker->Queue();
+  worker->Queue(this->data->executor);
 
   return deferred.Promise();
 
@@ -408,7 +450,7 @@ Napi::Value ODBCStatement::Prepare(const Napi::CallbackInfo& info) {
   data->sql = NapiStringToSQLTCHAR(sql);
 
   PrepareAsyncWorker *worker = new PrepareAsyncWorker(this, deferred);
-  worker->Queue();
+  worker->Queue(this->data->executor);
 
   return deferred.Promise();
 }
@@ -483,7 +525,7 @@ Napi::Value ODBCStatement::Bind(const Napi::CallbackInfo& info) {
   this->data->params = GetParametersFromArray(&parameterArray, &(data->paramCount));
 
   BindAsyncWorker *worker = new BindAsyncWorker(this, deferred);
-  worker->Queue();
+  worker->Queue(this->data->executor);
 
   return deferred.Promise();
 }
@@ -497,7 +539,9 @@ Napi::Value ODBCStatement::Bind(const Napi::CallbackInfo& info) {
 class ExecuteAsyncWorker : public DeferredAsyncWorker {
   public:
     ExecuteAsyncWorker(ODBCStatement *odbcStatementObject, Napi::Promise::Deferred deferred)
-    : DeferredAsyncWorker(deferred), odbcStatementObject(odbcStatementObject), data(odbcStatementObject->data) {}
+    : DeferredAsyncWorker(deferred), odbcStatementObject(odbcStatementObject), data(odbcStatementObject->data) {
+      Measure(Metrics::EXECUTE);
+    }
 
     ~ExecuteAsyncWorker() {}
 
@@ -505,8 +549,18 @@ class ExecuteAsyncWorker : public DeferredAsyncWorker {
 
       DEBUG_PRINTF("ODBCStatement::ExecuteAsyncWorker::Execute()\n");
 
+      // the handle was prepared already, so there is no allocated step
+      data->timings.started = uv_hrtime();
+
       data->sqlReturnCode = SQLExecute(data->hSTMT);
 
+      if (data->sqlReturnCode == SQL_NEED_DATA) {
+        // send the streamed parameters
+        data->sqlReturnCode = PutStreamedParameters(data);
+      }
+
+      data->timings.executed = uv_hrtime();
+
       if (SQL_SUCCEEDED(data->sqlReturnCode)) {
 
         BindColumns(data);
@@ -545,9 +599,19 @@ class ExecuteAsyncWorker : public DeferredAsyncWorker {
       Napi::Env env = Env();
       Napi::HandleScope scope(env);
 
+      // a parameter stream that failed is reported with its own error
+      Napi::Value streamError = GetParameterStreamError(env, data);
 
-      Reject(GetSQLError(env, SQL_HANDLE_STMT, data->hSTMT,
-            (char *) "[node-odbc] Error in ODBCStatement::ExecuteAsyncWorker"));
+      if (!streamError.IsUndefined()) {
+        Reject(streamError);
+        return;
+      }
+
+      Napi::Object error = GetSQLError(env, SQL_HANDLE_STMT, data->hSTMT,
+            (char *) "[node-odbc] Error in ODBCStatement::ExecuteAsyncWorker");
+      error.Set(Napi::String::New(env, "timings"), GetQueryTimings(env, data));
+
+      Reject(error);
     }
 
   private:
@@ -563,8 +627,218 @@ Napi::Value ODBCStatement::Execute(const Napi::CallbackInfo& info) {
 
   Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(info.Env());
 
+  // every execution is timed on its own
+  this->data->timings = QueryTimings();
+  this->data->timings.queued = uv_hrtime();
+
   ExecuteAsyncWorker *worker = new ExecuteAsyncWorker(this, deferred);
-  worker->Queue();
+  worker->Queue(this->data->executor);
+
+  return deferred.Promise();
+}
+
+/******************************************************************************
+ ******************************* EXECUTE MANY *********************************
+ *****************************************************************************/
+
+// ExecuteManyAsyncWorker, used by ExecuteMany function (see below)
+class ExecuteManyAsyncWorker : public DeferredAsyncWorker {
+
+  public:
+    ExecuteManyAsyncWorker(ODBCStatement *odbcStatementObject, std::vector<Parameter*> parameterSets,
+      std::vector<int> parameterCounts, Napi::Promise::Deferred deferred)
+    : DeferredAsyncWorker(deferred), odbcStatementObject(odbcStatementObject), data(odbcStatementObject->data),
+        parameterSets(parameterSets), parameterCounts(parameterCounts), failedIndex(-1) {
+      Measure(Metrics::EXECUTE);
+
+      // each set is bound through a QueryData of its own, the statement's
+      // keeps the parameters bound with bind()
+      setData = new QueryData();
+      setData->hSTMT = data->hSTMT;
+    }
+
+    ~ExecuteManyAsyncWorker() {
+      // the sets are freed here, not by setData
+      setData->params = NULL;
+      setData->paramCount = 0;
+      delete setData;
+
+      for (size_t i = 0; i < parameterSets.size(); i++) {
+        FreeParameters(parameterSets[i], parameterCounts[i]);
+      }
+    }
+
+    void Execute() {
+
+      DEBUG_PRINTF("ODBCStatement::ExecuteManyAsyncWorker::Execute()\n");
+
+      for (size_t i = 0; i < parameterSets.size(); i++) {
+
+        SQLFreeStmt(setData->hSTMT, SQL_RESET_PARAMS);
+
+        setData->params = parameterSets[i];
+        setData->paramCount = parameterCounts[i];
+        setData->sqlReturnCode = SQL_SUCCESS;
+
+        BindParameters(setData);
+
+        if (SQL_SUCCEEDED(setData->sqlReturnCode)) {
+          setData->sqlReturnCode = SQLExecute(setData->hSTMT);
+        }
+
+        if (setData->sqlReturnCode == SQL_NEED_DATA) {
+          // send the streamed parameters
+          setData->sqlReturnCode = PutStreamedParameters(setData);
+        }
+
+        if (!SQL_SUCCEEDED(setData->sqlReturnCode)) {
+          // the diagnostics don't survive resetting the handle below
+          CaptureSQLError(SQL_HANDLE_STMT, setData->hSTMT, &errors);
+          failedIndex = i;
+          break;
+        }
+
+        SQLLEN rowCount = 0;
+
+        if (!SQL_SUCCEEDED(SQLRowCount(setData->hSTMT, &rowCount))) {
+          rowCount = 0;
+        }
+
+        rowCounts.push_back(rowCount);
+
+        // discard any result set so the statement can be executed again
+        SQLFreeStmt(setData->hSTMT, SQL_CLOSE);
+      }
+
+      // the sets are freed with this worker, the handle mustn't point at
+      // them; the parameters bound with bind() are bound again instead
+      SQLFreeStmt(data->hSTMT, SQL_CLOSE);
+      SQLFreeStmt(data->hSTMT, SQL_RESET_PARAMS);
+
+      if (data->paramCount > 0) {
+        BindParameters(data);
+      }
+
+      if (failedIndex >= 0) {
+        SetError("ERROR");
+      }
+    }
+
+    void OnOK() {
+
+      DEBUG_PRINTF("ODBCStatement::ExecuteManyAsyncWorker::OnOk()\n");
+
+      Napi::Env env = Env();
+      Napi::HandleScope scope(env);
+
+      Resolve(GetRowCounts(env));
+    }
+
+    void OnError(const Napi::Error &e) {
+
+      DEBUG_PRINTF("ODBCStatement::ExecuteManyAsyncWorker::OnError()\n");
+
+      Napi::Env env = Env();
+      Napi::HandleScope scope(env);
+
+      // a parameter stream that failed is reported with its own error;
+      // setData still holds the failed set
+      Napi::Value error = GetParameterStreamError(env, setData);
+
+      if (error.IsUndefined()) {
+        error = GetSQLError(env, &errors,
+              (char *) "[node-odbc] Error in ODBCStatement::ExecuteManyAsyncWorker");
+      }
+
+      // tell the caller which set failed and what the earlier ones did
+      if (error.IsObject()) {
+        error.As<Napi::Object>().Set(Napi::String::New(env, "index"), Napi::Number::New(env, failedIndex));
+        error.As<Napi::Object>().Set(Napi::String::New(env, "rowCounts"), GetRowCounts(env));
+      }
+
+      Reject(error);
+    }
+
+  private:
+    Napi::Array GetRowCounts(Napi::Env env) {
+
+      Napi::Array counts = Napi::Array::New(env, rowCounts.size());
+
+      for (size_t i = 0; i < rowCounts.size(); i++) {
+        counts.Set(i, Napi::Number::New(env, rowCounts[i]));
+      }
+
+      return counts;
+    }
+
+    ODBCStatement *odbcStatementObject;
+    QueryData *data;
+    QueryData *setData;
+    std::vector<Parameter*> parameterSets;
+    std::vector<int> parameterCounts;
+    std::vector<SQLLEN> rowCounts;
+    std::vector<DiagnosticRecord> errors;
+    int failedIndex;
+};
+
+/*
+ *  ODBCStatement::ExecuteMany (Async)
+ *    Description: Executes the prepared statement once for every set of
+ *                 parameters, all in a single AsyncWorker, and returns the
+ *                 number of rows affected by each execution. Stops at the
+ *                 first set that fails. Parameters bound with bind() are not
+ *                 bound any more afterwards.
+ *
+ *    Parameters:
+ *      const Napi::CallbackInfo& info:
+ *        The information passed by Napi from the JavaScript call, including
+ *        arguments from the JavaScript function. In JavaScript, the
+ *        executeMany() function takes one argument.
+ *
+ *        info[0]: Array: an array of parameter arrays
+ *
+ *    Return:
+ *      Napi::Value:
+ *        A Promise that resolves to an array with the row count of each
+ *        execution. On failure the error has an 'index' property with the
+ *        position of the failed set and 'rowCounts' for the sets before it.
+ */
+Napi::Value ODBCStatement::ExecuteMany(const Napi::CallbackInfo& info) {
+
+  DEBUG_PRINTF("ODBCStatement::ExecuteMany\n");
+
+  Napi::Env env = info.Env();
+  Napi::HandleScope scope(env);
+
+  if (info.Length() < 1 || !info[0].IsArray()) {
+    Napi::TypeError::New(env, "executeMany() takes an Array of parameter Arrays").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  Napi::Array sets = info[0].As<Napi::Array>();
+
+  for (uint32_t i = 0; i < sets.Length(); i++) {
+    if (!sets.Get(i).IsArray()) {
+      Napi::TypeError::New(env, "executeMany() takes an Array of parameter Arrays").ThrowAsJavaScriptException();
+      return env.Null();
+    }
+  }
+
+  std::vector<Parameter*> parameterSets;
+  std::vector<int> parameterCounts;
+
+  for (uint32_t i = 0; i < sets.Length(); i++) {
+    Napi::Array parameterArray = sets.Get(i).As<Napi::Array>();
+    int paramCount = 0;
+
+    parameterSets.push_back(GetParametersFromArray(&parameterArray, &paramCount));
+    parameterCounts.push_back(paramCount);
+  }
+
+  Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(info.Env());
+
+  ExecuteManyAsyncWorker *worker = new ExecuteManyAsyncWorker(this, parameterSets, parameterCounts, deferred);
+  worker->Queue(this->data->executor);
 
   return deferred.Promise();
 }
@@ -578,7 +852,9 @@ class CloseAsyncWorker : public DeferredAsyncWorker {
   public:
     CloseAsyncWorker(ODBCStatement *odbcStatementObject, int closeOption, Napi::Promise::Deferred deferred)
     : DeferredAsyncWorker(deferred), odbcStatementObject(odbcStatementObject),
-        closeOption(closeOption), data(odbcStatementObject->data) {}
+        closeOption(closeOption), data(odbcStatementObject->data) {
+      Measure(Metrics::CLOSE);
+    }
 
     ~CloseAsyncWorker() {}
 
@@ -587,9 +863,9 @@ class CloseAsyncWorker : public DeferredAsyncWorker {
       if (closeOption == SQL_DESTROY) {
         odbcStatementObject->Free();
       } else {
-        uv_mutex_lock(&ODBC::g_odbcMutex);
+        data->connectionLock->Lock();
         data->sqlReturnCode = SQLFreeStmt(odbcStatementObject->m_hSTMT, closeOption);
-        uv_mutex_unlock(&ODBC::g_odbcMutex);
+        data->connectionLock->Unlock();
       }
 
       if (SQL_SUCCEEDED(data->sqlReturnCode)) {
@@ -634,7 +910,7 @@ Napi::Value ODBCStatement::Close(const Napi::CallbackInfo& info) {
   Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(info.Env());
 
   CloseAsyncWorker *worker = new CloseAsyncWorker(this, closeOption, deferred);
-  worker->Queue();
+  worker->Queue(this->data->executor);
 
   return deferred.Promise();
 }
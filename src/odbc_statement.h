@@ -18,15 +18,19 @@
 #define _SRC_ODBC_STATEMENT_H
 
 #include "declarations.h"
+#include "statement_pool.h"
 
 class ODBCStatement : public Napi::ObjectWrap<ODBCStatement> {
   public:
     static Napi::FunctionReference constructor;
     static Napi::Object Init(Napi::Env env, Napi::Object exports);
 
-    static SQLHENV m_hENV;
-    static SQLHDBC m_hDBC;
-    static SQLHSTMT m_hSTMT;
+    SQLHENV m_hENV;
+    SQLHDBC m_hDBC;
+    SQLHSTMT m_hSTMT;
+
+    // the connection's pool, m_hSTMT is returned to it when freed
+    std::shared_ptr<StatementPool> statementPool;
 
     QueryData *data;
 
@@ -40,6 +44,7 @@ class ODBCStatement : public Napi::ObjectWrap<ODBCStatement> {
     Napi::Value Prepare(const Napi::CallbackInfo& info);
     Napi::Value Bind(const Napi::CallbackInfo& info);
     Napi::Value Execute(const Napi::CallbackInfo& info);
+    Napi::Value ExecuteMany(const Napi::CallbackInfo& info);
     Napi::Value Close(const Napi::CallbackInfo& info);
 };
 #endif
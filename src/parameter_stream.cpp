@@ -0,0 +1,306 @@
+#include "parameter_stream.h"
+
+ParameterStream::ParameterStream(Napi::Env env, Napi::Object iterator) {
+
+  this->iterator = Napi::Persistent(iterator);
+  this->state = IDLE;
+  this->returned = false;
+  this->alive = std::make_shared<bool>(true);
+  this->chunkData = NULL;
+  this->chunkLength = 0;
+
+  uv_mutex_init(&this->mutex);
+  uv_cond_init(&this->cond);
+
+  uv_loop_t *loop;
+  napi_get_uv_event_loop(env, &loop);
+
+  // the async handle is only used to wake the main thread while a worker is
+  // running, so it must not keep the event loop alive on its own
+  this->async = new uv_async_t;
+  this->async->data = this;
+  uv_async_init(loop, this->async, ParameterStream::RequestChunk);
+  uv_unref((uv_handle_t *) this->async);
+
+  napi_async_init(env, Napi::Object::New(env), Napi::String::New(env, "ODBCParameterStream"), &this->asyncContext);
+}
+
+ParameterStream::~ParameterStream() {
+
+  DEBUG_PRINTF("ParameterStream::~ParameterStream\n");
+
+  // the stream may not have been read to its end (the query failed before
+  // it got to it), the worker may have finished before the main thread got
+  // to a pending return(), or left a next() unsettled; the source is
+  // released now, and a late settlement of next() is ignored
+  if (this->state != DONE && this->state != FAILED) {
+    this->Return();
+  }
+
+  *this->alive = false;
+
+  napi_async_destroy(this->iterator.Env(), this->asyncContext);
+
+  this->async->data = NULL;
+  uv_close((uv_handle_t *) this->async, ParameterStream::CloseHandle);
+
+  uv_cond_destroy(&this->cond);
+  uv_mutex_destroy(&this->mutex);
+}
+
+void ParameterStream::CloseHandle(uv_handle_t *handle) {
+  delete (uv_async_t *) handle;
+}
+
+bool ParameterStream::IsStreamable(Napi::Env env, Napi::Value value) {
+
+  if (!value.IsObject() || value.IsArray() || value.IsTypedArray() || value.IsArrayBuffer()) {
+    return false;
+  }
+
+  Napi::Value asyncIterator = env.Global().Get("Symbol").As<Napi::Object>().Get("asyncIterator");
+
+  return value.As<Napi::Object>().Get(asyncIterator).IsFunction();
+}
+
+ParameterStream* ParameterStream::FromIterable(Napi::Env env, Napi::Value value) {
+
+  Napi::Object iterable = value.As<Napi::Object>();
+  Napi::Value asyncIterator = env.Global().Get("Symbol").As<Napi::Object>().Get("asyncIterator");
+
+  Napi::Value iterator = iterable.Get(asyncIterator).As<Napi::Function>().Call(iterable, {});
+
+  if (iterator.IsEmpty() || !iterator.IsObject()) {
+    return NULL;
+  }
+
+  return new ParameterStream(env, iterator.As<Napi::Object>());
+}
+
+/*
+ * Worker thread
+ */
+
+bool ParameterStream::Next(SQLPOINTER *chunk, SQLLEN *length) {
+
+  uv_mutex_lock(&this->mutex);
+
+  if (this->state == DONE || this->state == FAILED || this->state == CANCELLED) {
+    uv_mutex_unlock(&this->mutex);
+    return false;
+  }
+
+  this->state = REQUESTED;
+  uv_async_send(this->async);
+
+  while (this->state == REQUESTED) {
+    uv_cond_wait(&this->cond, &this->mutex);
+  }
+
+  bool ready = this->state == READY;
+
+  if (ready) {
+    *chunk = this->chunkData;
+    *length = this->chunkLength;
+  }
+
+  uv_mutex_unlock(&this->mutex);
+
+  return ready;
+}
+
+void ParameterStream::Cancel() {
+
+  uv_mutex_lock(&this->mutex);
+
+  if (this->state != DONE && this->state != FAILED && this->state != CANCELLED) {
+    this->state = CANCELLED;
+    uv_cond_signal(&this->cond);
+    uv_async_send(this->async);
+  }
+
+  uv_mutex_unlock(&this->mutex);
+}
+
+bool ParameterStream::Failed() {
+
+  uv_mutex_lock(&this->mutex);
+  bool failed = this->state == FAILED;
+  uv_mutex_unlock(&this->mutex);
+
+  return failed;
+}
+
+bool ParameterStream::Cancelled() {
+
+  uv_mutex_lock(&this->mutex);
+  bool cancelled = this->state == CANCELLED;
+  uv_mutex_unlock(&this->mutex);
+
+  return cancelled;
+}
+
+/*
+ * Main thread
+ */
+
+Napi::Value ParameterStream::Error(Napi::Env env) {
+
+  if (this->errorReference.IsEmpty()) {
+    return env.Undefined();
+  }
+
+  return this->errorReference.Value();
+}
+
+void ParameterStream::RequestChunk(uv_async_t *handle) {
+
+  ParameterStream *stream = (ParameterStream *) handle->data;
+
+  if (stream == NULL) {
+    return;
+  }
+
+  Napi::Env env = stream->iterator.Env();
+  Napi::HandleScope scope(env);
+
+  // the previous chunk has been handed to SQLPutData, it doesn't need to be
+  // kept alive any more
+  stream->chunkReference.Reset();
+  stream->chunkString.clear();
+
+  uv_mutex_lock(&stream->mutex);
+  State state = stream->state;
+  uv_mutex_unlock(&stream->mutex);
+
+  // run the iterator inside a callback scope so that the promise reactions
+  // queued by next() are processed when we return to the event loop
+  napi_callback_scope callbackScope;
+  napi_open_callback_scope(env, Napi::Object::New(env), stream->asyncContext, &callbackScope);
+
+  Napi::Object iterator = stream->iterator.Value();
+
+  if (state == CANCELLED) {
+    // execution was abandoned part way through, let the source clean up
+    stream->Return();
+  } else if (state == REQUESTED) {
+    Napi::Value nextFunction = iterator.Get("next");
+    Napi::Value result;
+
+    if (nextFunction.IsFunction()) {
+      result = nextFunction.As<Napi::Function>().Call(iterator, {});
+    }
+
+    if (env.IsExceptionPending()) {
+      stream->OnFailure(env.GetAndClearPendingException().Value());
+    } else if (result.IsEmpty() || !result.IsObject()) {
+      stream->OnFailure(Napi::TypeError::New(env, "[node-odbc] Parameter stream iterator did not return an object").Value());
+    } else if (result.IsPromise()) {
+      Napi::Object promise = result.As<Napi::Object>();
+
+      std::shared_ptr<bool> alive = stream->alive;
+
+      Napi::Function onFulfilled = Napi::Function::New(env, [stream, alive](const Napi::CallbackInfo& info) {
+        if (*alive) {
+          stream->OnResult(info[0]);
+        }
+      });
+
+      Napi::Function onRejected = Napi::Function::New(env, [stream, alive](const Napi::CallbackInfo& info) {
+        if (*alive) {
+          stream->OnFailure(info[0]);
+        }
+      });
+
+      promise.Get("then").As<Napi::Function>().Call(promise, { onFulfilled, onRejected });
+    } else {
+      stream->OnResult(result);
+    }
+  }
+
+  napi_close_callback_scope(env, callbackScope);
+}
+
+void ParameterStream::OnResult(Napi::Value result) {
+
+  Napi::Env env = result.Env();
+
+  if (!result.IsObject()) {
+    OnFailure(Napi::TypeError::New(env, "[node-odbc] Parameter stream iterator result must be an object").Value());
+    return;
+  }
+
+  Napi::Object iteratorResult = result.As<Napi::Object>();
+
+  if (iteratorResult.Get("done").ToBoolean().Value()) {
+    SetState(DONE);
+    return;
+  }
+
+  Napi::Value value = iteratorResult.Get("value");
+
+  if (value.IsTypedArray()) {
+    // covers Buffer; the bytes are read in place while the reference pins them
+    Napi::TypedArray typedArray = value.As<Napi::TypedArray>();
+    this->chunkData = (char *) typedArray.ArrayBuffer().Data() + typedArray.ByteOffset();
+    this->chunkLength = typedArray.ByteLength();
+  } else if (value.IsArrayBuffer()) {
+    Napi::ArrayBuffer arrayBuffer = value.As<Napi::ArrayBuffer>();
+    this->chunkData = arrayBuffer.Data();
+    this->chunkLength = arrayBuffer.ByteLength();
+  } else if (value.IsString()) {
+    this->chunkString = value.As<Napi::String>().Utf8Value();
+    this->chunkData = (SQLPOINTER) this->chunkString.data();
+    this->chunkLength = this->chunkString.length();
+  } else {
+    OnFailure(Napi::TypeError::New(env, "[node-odbc] Parameter stream chunks must be Buffers, ArrayBuffers or strings").Value());
+    return;
+  }
+
+  this->chunkReference = Napi::Reference<Napi::Value>::New(value, 1);
+
+  SetState(READY);
+}
+
+void ParameterStream::OnFailure(Napi::Value error) {
+
+  this->errorReference = Napi::Reference<Napi::Value>::New(error, 1);
+
+  SetState(FAILED);
+}
+
+void ParameterStream::SetState(State state) {
+
+  uv_mutex_lock(&this->mutex);
+
+  // a chunk that arrives after the execution was abandoned isn't wanted
+  if (this->state != CANCELLED) {
+    this->state = state;
+    uv_cond_signal(&this->cond);
+  }
+
+  uv_mutex_unlock(&this->mutex);
+}
+
+void ParameterStream::Return() {
+
+  if (this->returned) {
+    return;
+  }
+
+  this->returned = true;
+
+  Napi::Env env = this->iterator.Env();
+  Napi::HandleScope scope(env);
+
+  Napi::Object iterator = this->iterator.Value();
+  Napi::Value returnFunction = iterator.Get("return");
+
+  if (returnFunction.IsFunction()) {
+    returnFunction.As<Napi::Function>().Call(iterator, {});
+  }
+
+  if (env.IsExceptionPending()) {
+    env.GetAndClearPendingException();
+  }
+}
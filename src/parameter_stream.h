@@ -0,0 +1,85 @@
+#ifndef _SRC_PARAMETER_STREAM_H
+#define _SRC_PARAMETER_STREAM_H
+
+#include <memory>
+
+#include "declarations.h"
+
+/*
+ * ParameterStream
+ *
+ *   Feeds a data-at-execution parameter (SQL_DATA_AT_EXEC) from a JavaScript
+ *   async iterable, e.g. a Readable stream. The AsyncWorker thread calls Next()
+ *   after SQLParamData asks for the parameter; Next() wakes the main thread,
+ *   which pulls exactly one chunk from the iterator and hands it back. A new
+ *   chunk is only requested once the previous one has been passed to
+ *   SQLPutData, so the stream is never read faster than the driver consumes it.
+ *
+ *   A stream that is destroyed before it ended has its iterator's return()
+ *   called, so a source such as an fs stream is always released.
+ *
+ *   Must be created and destroyed on the main thread.
+ */
+class ParameterStream {
+
+  public:
+    ParameterStream(Napi::Env env, Napi::Object iterator);
+    ~ParameterStream();
+
+    // returns true if value is an async iterable that can be bound as a stream
+    static bool IsStreamable(Napi::Env env, Napi::Value value);
+
+    // creates a ParameterStream over the async iterator of value
+    static ParameterStream* FromIterable(Napi::Env env, Napi::Value value);
+
+    // worker thread: blocks until the next chunk is available. Returns false
+    // when the stream has ended, failed or was cancelled.
+    bool Next(SQLPOINTER *chunk, SQLLEN *length);
+
+    // any thread: the execution was abandoned before the stream ended (the
+    // driver failed, or the query was aborted). Wakes a worker waiting in
+    // Next(); the iterator's return() is called so the source can release
+    // its resources
+    void Cancel();
+
+    // true if the iterator rejected or produced a value that isn't binary data
+    bool Failed();
+
+    // true if Cancel() was called before the stream ended
+    bool Cancelled();
+
+    // main thread: the rejection reason, or undefined
+    Napi::Value Error(Napi::Env env);
+
+  private:
+    enum State { IDLE, REQUESTED, READY, DONE, FAILED, CANCELLED };
+
+    static void RequestChunk(uv_async_t *handle);
+    static void CloseHandle(uv_handle_t *handle);
+
+    void OnResult(Napi::Value result);
+    void OnFailure(Napi::Value error);
+    void SetState(State state);
+
+    // main thread: calls the iterator's return() once
+    void Return();
+
+    uv_async_t         *async;
+    napi_async_context  asyncContext;
+    uv_mutex_t          mutex;
+    uv_cond_t           cond;
+    State               state;
+
+    // main thread only
+    bool                  returned;
+    std::shared_ptr<bool> alive;
+
+    Napi::ObjectReference        iterator;
+    Napi::Reference<Napi::Value> chunkReference;
+    Napi::Reference<Napi::Value> errorReference;
+    std::string                  chunkString;
+    SQLPOINTER                   chunkData;
+    SQLLEN                       chunkLength;
+};
+
+#endif
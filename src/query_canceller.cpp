@@ -0,0 +1,107 @@
+#include "query_canceller.h"
+
+QueryCanceller::QueryCanceller() : hSTMT(SQL_NULL_HSTMT), cancelled(false) {
+
+  uv_mutex_init(&this->mutex);
+}
+
+QueryCanceller::~QueryCanceller() {
+
+  this->Unlisten();
+
+  uv_mutex_destroy(&this->mutex);
+}
+
+bool QueryCanceller::Begin(SQLHSTMT hSTMT) {
+
+  uv_mutex_lock(&this->mutex);
+
+  bool cancelled = this->cancelled;
+
+  if (!cancelled) {
+    this->hSTMT = hSTMT;
+  }
+
+  uv_mutex_unlock(&this->mutex);
+
+  return !cancelled;
+}
+
+void QueryCanceller::End() {
+
+  uv_mutex_lock(&this->mutex);
+  this->hSTMT = SQL_NULL_HSTMT;
+  uv_mutex_unlock(&this->mutex);
+}
+
+void QueryCanceller::Cancel() {
+
+  DEBUG_PRINTF("QueryCanceller::Cancel\n");
+
+  uv_mutex_lock(&this->mutex);
+
+  this->cancelled = true;
+
+  // SQLCancel is meant to be called from another thread while the statement
+  // executes; the executing call then returns SQL_ERROR with SQLSTATE HY008
+  if (this->hSTMT != SQL_NULL_HSTMT) {
+    SQLCancel(this->hSTMT);
+  }
+
+  uv_mutex_unlock(&this->mutex);
+
+  for (size_t i = 0; i < this->callbacks.size(); i++) {
+    this->callbacks[i]();
+  }
+}
+
+void QueryCanceller::OnCancel(std::function<void()> callback) {
+  this->callbacks.push_back(callback);
+}
+
+bool QueryCanceller::Cancelled() {
+
+  uv_mutex_lock(&this->mutex);
+  bool cancelled = this->cancelled;
+  uv_mutex_unlock(&this->mutex);
+
+  return cancelled;
+}
+
+void QueryCanceller::Listen(Napi::Env env, Napi::Object signal) {
+
+  Napi::Function listener = Napi::Function::New(env, [this](const Napi::CallbackInfo& info) {
+    this->Cancel();
+  });
+
+  Napi::Value addEventListener = signal.Get("addEventListener");
+
+  if (!addEventListener.IsFunction()) {
+    return;
+  }
+
+  addEventListener.As<Napi::Function>().Call(signal, { Napi::String::New(env, "abort"), listener });
+
+  this->signal = Napi::Persistent(signal);
+  this->listener = Napi::Persistent(listener);
+}
+
+void QueryCanceller::Unlisten() {
+
+  if (this->signal.IsEmpty()) {
+    return;
+  }
+
+  Napi::Env env = this->signal.Env();
+  Napi::HandleScope scope(env);
+
+  Napi::Object signal = this->signal.Value();
+  Napi::Value removeEventListener = signal.Get("removeEventListener");
+
+  if (removeEventListener.IsFunction()) {
+    removeEventListener.As<Napi::Function>().Call(signal, { Napi::String::New(env, "abort"), this->listener.Value() });
+  }
+
+  this->signal.Reset();
+  this->listener.Reset();
+}
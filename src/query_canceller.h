@@ -0,0 +1,58 @@
+#ifndef _SRC_QUERY_CANCELLER_H
+#define _SRC_QUERY_CANCELLER_H
+
+#include <functional>
+#include <vector>
+
+#include "declarations.h"
+
+/*
+ * QueryCanceller
+ *
+ *   Cancels a query from the main thread while a worker (or AsyncExecution)
+ *   is executing it. The executing side brackets the execution with Begin()
+ *   and End(); Cancel() calls SQLCancel on the statement handle if it is
+ *   executing at that moment, and otherwise makes the next Begin() fail so the
+ *   statement never starts.
+ *
+ *   Listen() hooks Cancel() up to an AbortSignal's 'abort' event. Work the
+ *   query waits on outside the driver (a parameter stream) registers with
+ *   OnCancel() so that it is woken up too.
+ */
+class QueryCanceller {
+
+  public:
+    QueryCanceller();
+    ~QueryCanceller();
+
+    // worker thread: hSTMT is about to execute. Returns false if the query
+    // was cancelled already.
+    bool Begin(SQLHSTMT hSTMT);
+
+    // worker thread: the execution returned
+    void End();
+
+    // main thread
+    void Cancel();
+    bool Cancelled();
+
+    // main thread: call Cancel() when signal aborts, until Unlisten()
+    void Listen(Napi::Env env, Napi::Object signal);
+    void Unlisten();
+
+    // main thread: callback is called by Cancel(); whatever it refers to must
+    // outlive the canceller or its listening
+    void OnCancel(std::function<void()> callback);
+
+  private:
+    uv_mutex_t mutex;
+    SQLHSTMT   hSTMT;
+    bool       cancelled;
+
+    Napi::ObjectReference   signal;
+    Napi::FunctionReference listener;
+
+    std::vector<std::function<void()>> callbacks;
+};
+
+#endif
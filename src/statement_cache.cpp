@@ -0,0 +1,226 @@
+#include "statement_cache.h"
+#include "metrics.h"
+
+// the key is the raw SQLTCHAR text, so it works for both ANSI and UNICODE builds
+static std::string CacheKey(SQLTCHAR *sql) {
+
+  size_t length = 0;
+
+  while (sql[length] != 0) {
+    length++;
+  }
+
+  return std::string((const char *) sql, length * sizeof(SQLTCHAR));
+}
+
+StatementCache::StatementCache(std::shared_ptr<StatementPool> pool, unsigned int capacity)
+  : pool(pool), capacity(capacity), closed(false), hits(0), misses(0), evictions(0) {
+
+  uv_mutex_init(&this->mutex);
+}
+
+StatementCache::~StatementCache() {
+
+  this->Close();
+
+  uv_mutex_destroy(&this->mutex);
+}
+
+SQLRETURN StatementCache::Acquire(SQLTCHAR *sql, SQLHSTMT *hSTMT) {
+
+  std::string key = CacheKey(sql);
+
+  uv_mutex_lock(&this->mutex);
+
+  std::unordered_map<std::string, std::list<Entry>::iterator>::iterator found = this->index.find(key);
+
+  if (found != this->index.end() && !found->second->inUse) {
+
+    // hit: mark it busy and move it to the front of the LRU list
+    found->second->inUse = true;
+    this->entries.splice(this->entries.begin(), this->entries, found->second);
+    *hSTMT = found->second->hSTMT;
+    this->hits++;
+
+    uv_mutex_unlock(&this->mutex);
+
+    Metrics::StatementCacheLookup(true);
+    return SQL_SUCCESS;
+  }
+
+  // a busy handle for the same SQL is not replaced, the new one is private
+  bool cacheable = !this->closed && this->capacity > 0 && found == this->index.end();
+  this->misses++;
+
+  uv_mutex_unlock(&this->mutex);
+
+  Metrics::StatementCacheLookup(false);
+
+  SQLRETURN sqlReturnCode = this->pool->Checkout(hSTMT);
+
+  if (!SQL_SUCCEEDED(sqlReturnCode)) {
+    return sqlReturnCode;
+  }
+
+  sqlReturnCode = SQLPrepare(*hSTMT, sql, SQL_NTS);
+
+  if (!SQL_SUCCEEDED(sqlReturnCode) || !cacheable) {
+    return sqlReturnCode;
+  }
+
+  std::vector<SQLHSTMT> evicted;
+
+  uv_mutex_lock(&this->mutex);
+
+  // another worker may have cached the same SQL while we were preparing
+  if (!this->closed && this->index.find(key) == this->index.end()) {
+    Entry entry = { key, *hSTMT, true };
+    this->entries.push_front(entry);
+    this->index[key] = this->entries.begin();
+    this->Trim(&evicted);
+  }
+
+  uv_mutex_unlock(&this->mutex);
+
+  this->ReturnHandles(&evicted);
+
+  return sqlReturnCode;
+}
+
+void StatementCache::Release(SQLHSTMT hSTMT) {
+
+  if (hSTMT == SQL_NULL_HSTMT) {
+    return;
+  }
+
+  uv_mutex_lock(&this->mutex);
+
+  bool cached = false;
+
+  for (std::list<Entry>::iterator entry = this->entries.begin(); entry != this->entries.end(); ++entry) {
+    if (entry->hSTMT == hSTMT) {
+      cached = true;
+      break;
+    }
+  }
+
+  uv_mutex_unlock(&this->mutex);
+
+  if (!cached) {
+    this->pool->Return(hSTMT);
+    return;
+  }
+
+  // keep the prepared plan, drop the cursor, column bindings and parameters
+  SQLFreeStmt(hSTMT, SQL_CLOSE);
+  SQLFreeStmt(hSTMT, SQL_UNBIND);
+  SQLFreeStmt(hSTMT, SQL_RESET_PARAMS);
+
+  std::vector<SQLHSTMT> evicted;
+
+  uv_mutex_lock(&this->mutex);
+
+  for (std::list<Entry>::iterator entry = this->entries.begin(); entry != this->entries.end(); ++entry) {
+    if (entry->hSTMT == hSTMT) {
+      entry->inUse = false;
+      break;
+    }
+  }
+
+  this->Trim(&evicted);
+
+  uv_mutex_unlock(&this->mutex);
+
+  this->ReturnHandles(&evicted);
+}
+
+void StatementCache::Close() {
+
+  std::vector<SQLHSTMT> idle;
+
+  uv_mutex_lock(&this->mutex);
+
+  if (!this->closed) {
+    for (std::list<Entry>::iterator entry = this->entries.begin(); entry != this->entries.end(); ++entry) {
+      if (!entry->inUse) {
+        idle.push_back(entry->hSTMT);
+      }
+    }
+
+    this->entries.clear();
+    this->index.clear();
+    this->closed = true;
+  }
+
+  uv_mutex_unlock(&this->mutex);
+
+  for (size_t i = 0; i < idle.size(); i++) {
+    this->pool->Free(idle[i]);
+  }
+}
+
+unsigned int StatementCache::Capacity() {
+
+  uv_mutex_lock(&this->mutex);
+  unsigned int capacity = this->capacity;
+  uv_mutex_unlock(&this->mutex);
+
+  return capacity;
+}
+
+void StatementCache::SetCapacity(unsigned int capacity) {
+
+  std::vector<SQLHSTMT> evicted;
+
+  uv_mutex_lock(&this->mutex);
+  this->capacity = capacity;
+  this->Trim(&evicted);
+  uv_mutex_unlock(&this->mutex);
+
+  this->ReturnHandles(&evicted);
+}
+
+Napi::Object StatementCache::Stats(Napi::Env env) {
+
+  uv_mutex_lock(&this->mutex);
+
+  Napi::Object stats = Napi::Object::New(env);
+  stats.Set(Napi::String::New(env, "size"), Napi::Number::New(env, this->entries.size()));
+  stats.Set(Napi::String::New(env, "capacity"), Napi::Number::New(env, this->capacity));
+  stats.Set(Napi::String::New(env, "hits"), Napi::Number::New(env, this->hits));
+  stats.Set(Napi::String::New(env, "misses"), Napi::Number::New(env, this->misses));
+  stats.Set(Napi::String::New(env, "evictions"), Napi::Number::New(env, this->evictions));
+
+  uv_mutex_unlock(&this->mutex);
+
+  return stats;
+}
+
+// must be called with the cache mutex held
+void StatementCache::Trim(std::vector<SQLHSTMT> *evicted) {
+
+  std::list<Entry>::iterator entry = this->entries.end();
+
+  while (this->entries.size() > this->capacity && entry != this->entries.begin()) {
+
+    --entry;
+
+    // busy handles stay until they are released
+    if (entry->inUse) {
+      continue;
+    }
+
+    evicted->push_back(entry->hSTMT);
+    this->index.erase(entry->key);
+    entry = this->entries.erase(entry);
+    this->evictions++;
+  }
+}
+
+// evicted statements are still valid handles, the pool can reuse them
+void StatementCache::ReturnHandles(std::vector<SQLHSTMT> *handles) {
+
+  for (size_t i = 0; i < handles->size(); i++) {
+    this->pool->Return((*handles)[i]);
+  }
+}
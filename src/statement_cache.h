@@ -0,0 +1,75 @@
+#ifndef _SRC_STATEMENT_CACHE_H
+#define _SRC_STATEMENT_CACHE_H
+
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "declarations.h"
+#include "statement_pool.h"
+
+/*
+ * StatementCache
+ *
+ *   A per-connection LRU cache of prepared statement handles, keyed by the SQL
+ *   text. Parameterized query() calls take a handle out of the cache, bind and
+ *   SQLExecute it, and give it back when their ODBCResult is closed, so the
+ *   server only has to parse and plan each distinct statement once.
+ *
+ *   A handle is only ever used by one query at a time: if the cached handle
+ *   for a statement is still busy, a new one is prepared for that query and
+ *   handed back to the connection's StatementPool when it is released.
+ *   Handles are checked out of and evicted into that pool as well.
+ *
+ *   Acquire and Release are called from AsyncWorker threads and from the main
+ *   thread, everything is guarded by the cache's own mutex.
+ */
+class StatementCache {
+
+  public:
+    StatementCache(std::shared_ptr<StatementPool> pool, unsigned int capacity);
+    ~StatementCache();
+
+    // returns an idle prepared handle for sql, preparing it on a miss
+    SQLRETURN Acquire(SQLTCHAR *sql, SQLHSTMT *hSTMT);
+
+    // gives back a handle returned by Acquire
+    void Release(SQLHSTMT hSTMT);
+
+    // frees all idle handles and stops caching; handles released later go
+    // straight back to the pool
+    void Close();
+
+    unsigned int Capacity();
+    void SetCapacity(unsigned int capacity);
+
+    Napi::Object Stats(Napi::Env env);
+
+  private:
+    typedef struct Entry {
+      std::string key;
+      SQLHSTMT    hSTMT;
+      bool        inUse;
+    } Entry;
+
+    // evicts idle entries from the tail until the cache fits its capacity
+    void Trim(std::vector<SQLHSTMT> *evicted);
+    void ReturnHandles(std::vector<SQLHSTMT> *handles);
+
+    std::shared_ptr<StatementPool> pool;
+    unsigned int capacity;
+    bool         closed;
+
+    // most recently used first
+    std::list<Entry> entries;
+    std::unordered_map<std::string, std::list<Entry>::iterator> index;
+
+    uv_mutex_t mutex;
+
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+};
+
+#endif
@@ -0,0 +1,209 @@
+#include "statement_pool.h"
+#include "metrics.h"
+
+StatementPool::StatementPool(SQLHDBC hDBC, std::shared_ptr<HandleLock> lock, unsigned int maxIdle)
+  : hDBC(hDBC), lock(lock), maxIdle(maxIdle), closed(false), outstanding(0), allocations(0), reuses(0), discards(0) {
+
+  uv_mutex_init(&this->mutex);
+}
+
+StatementPool::~StatementPool() {
+
+  this->Close();
+
+  uv_mutex_destroy(&this->mutex);
+}
+
+SQLRETURN StatementPool::Checkout(SQLHSTMT *hSTMT) {
+
+  uv_mutex_lock(&this->mutex);
+
+  if (!this->idle.empty()) {
+    *hSTMT = this->idle.back();
+    this->idle.pop_back();
+    this->checkedOut.insert(*hSTMT);
+    this->outstanding++;
+    this->reuses++;
+
+    uv_mutex_unlock(&this->mutex);
+
+    Metrics::StatementPoolCheckout(true);
+    return SQL_SUCCESS;
+  }
+
+  uv_mutex_unlock(&this->mutex);
+
+  this->lock->Lock();
+  SQLRETURN sqlReturnCode = SQLAllocHandle(SQL_HANDLE_STMT, this->hDBC, hSTMT);
+  this->lock->Unlock();
+
+  if (!SQL_SUCCEEDED(sqlReturnCode)) {
+    *hSTMT = SQL_NULL_HSTMT;
+    return sqlReturnCode;
+  }
+
+  uv_mutex_lock(&this->mutex);
+  this->checkedOut.insert(*hSTMT);
+  this->outstanding++;
+  this->allocations++;
+  uv_mutex_unlock(&this->mutex);
+
+  Metrics::StatementPoolCheckout(false);
+
+  return sqlReturnCode;
+}
+
+void StatementPool::Return(SQLHSTMT hSTMT) {
+
+  if (hSTMT == SQL_NULL_HSTMT) {
+    return;
+  }
+
+  uv_mutex_lock(&this->mutex);
+
+  this->checkedOut.erase(hSTMT);
+  this->outstanding--;
+
+  // after Close the connection is gone, and its statements with it
+  if (this->closed) {
+    uv_mutex_unlock(&this->mutex);
+    return;
+  }
+
+  bool keep = this->idle.size() < this->maxIdle;
+
+  uv_mutex_unlock(&this->mutex);
+
+  // drop the cursor, column bindings and parameters so the next user gets a
+  // handle that looks freshly allocated
+  if (keep) {
+    keep = SQL_SUCCEEDED(SQLFreeStmt(hSTMT, SQL_CLOSE)) &&
+           SQL_SUCCEEDED(SQLFreeStmt(hSTMT, SQL_UNBIND)) &&
+           SQL_SUCCEEDED(SQLFreeStmt(hSTMT, SQL_RESET_PARAMS));
+  }
+
+  uv_mutex_lock(&this->mutex);
+
+  // the pool may have filled up or closed while the handle was being reset
+  if (keep && !this->closed && this->idle.size() < this->maxIdle) {
+    this->idle.push_back(hSTMT);
+    uv_mutex_unlock(&this->mutex);
+    return;
+  }
+
+  bool closed = this->closed;
+  this->discards++;
+
+  uv_mutex_unlock(&this->mutex);
+
+  if (!closed) {
+    this->lock->Lock();
+    SQLFreeHandle(SQL_HANDLE_STMT, hSTMT);
+    this->lock->Unlock();
+  }
+}
+
+void StatementPool::Free(SQLHSTMT hSTMT) {
+
+  if (hSTMT == SQL_NULL_HSTMT) {
+    return;
+  }
+
+  uv_mutex_lock(&this->mutex);
+  this->checkedOut.erase(hSTMT);
+  this->outstanding--;
+  this->discards++;
+  bool closed = this->closed;
+  uv_mutex_unlock(&this->mutex);
+
+  if (!closed) {
+    this->lock->Lock();
+    SQLFreeHandle(SQL_HANDLE_STMT, hSTMT);
+    this->lock->Unlock();
+  }
+}
+
+void StatementPool::Close() {
+
+  std::vector<SQLHSTMT> handles;
+
+  uv_mutex_lock(&this->mutex);
+
+  if (!this->closed) {
+    handles.swap(this->idle);
+    this->closed = true;
+  }
+
+  uv_mutex_unlock(&this->mutex);
+
+  this->FreeHandles(&handles);
+}
+
+size_t StatementPool::CheckedOut() {
+
+  uv_mutex_lock(&this->mutex);
+  size_t count = this->checkedOut.size();
+  uv_mutex_unlock(&this->mutex);
+
+  return count;
+}
+
+unsigned int StatementPool::MaxIdle() {
+
+  uv_mutex_lock(&this->mutex);
+  unsigned int maxIdle = this->maxIdle;
+  uv_mutex_unlock(&this->mutex);
+
+  return maxIdle;
+}
+
+void StatementPool::SetMaxIdle(unsigned int maxIdle) {
+
+  std::vector<SQLHSTMT> surplus;
+
+  uv_mutex_lock(&this->mutex);
+
+  this->maxIdle = maxIdle;
+
+  while (this->idle.size() > this->maxIdle) {
+    surplus.push_back(this->idle.back());
+    this->idle.pop_back();
+    this->discards++;
+  }
+
+  uv_mutex_unlock(&this->mutex);
+
+  this->FreeHandles(&surplus);
+}
+
+Napi::Object StatementPool::Stats(Napi::Env env) {
+
+  uv_mutex_lock(&this->mutex);
+
+  Napi::Object stats = Napi::Object::New(env);
+  stats.Set(Napi::String::New(env, "idle"), Napi::Number::New(env, this->idle.size()));
+  stats.Set(Napi::String::New(env, "maxIdle"), Napi::Number::New(env, this->maxIdle));
+  stats.Set(Napi::String::New(env, "outstanding"), Napi::Number::New(env, this->outstanding));
+  stats.Set(Napi::String::New(env, "allocations"), Napi::Number::New(env, this->allocations));
+  stats.Set(Napi::String::New(env, "reuses"), Napi::Number::New(env, this->reuses));
+  stats.Set(Napi::String::New(env, "discards"), Napi::Number::New(env, this->discards));
+
+  uv_mutex_unlock(&this->mutex);
+
+  return stats;
+}
+
+void StatementPool::FreeHandles(std::vector<SQLHSTMT> *handles) {
+
+  if (handles->empty()) {
+    return;
+  }
+
+  this->lock->Lock();
+
+  for (size_t i = 0; i < handles->size(); i++) {
+    SQLFreeHandle(SQL_HANDLE_STMT, (*handles)[i]);
+  }
+
+  this->lock->Unlock();
+}
@@ -0,0 +1,72 @@
+#ifndef _SRC_STATEMENT_POOL_H
+#define _SRC_STATEMENT_POOL_H
+
+#include <unordered_set>
+#include <vector>
+
+#include "declarations.h"
+#include "handle_lock.h"
+
+/*
+ * StatementPool
+ *
+ *   A per-connection pool of reset statement handles. query(), tables(),
+ *   columns() and createStatement() check a handle out instead of allocating
+ *   one, and return it when their result or statement is closed. Returned
+ *   handles are reset with SQLFreeStmt (SQL_CLOSE, SQL_UNBIND and
+ *   SQL_RESET_PARAMS) and kept for the next checkout, so most queries never
+ *   touch SQLAllocHandle/SQLFreeHandle or the connection's HandleLock.
+ *
+ *   At most maxIdle handles are kept; handles returned to a full pool, or
+ *   that fail to reset, are freed.
+ *
+ *   Checkout and Return are called from AsyncWorker threads and from the main
+ *   thread, everything is guarded by the pool's own mutex.
+ */
+class StatementPool {
+
+  public:
+    StatementPool(SQLHDBC hDBC, std::shared_ptr<HandleLock> lock, unsigned int maxIdle);
+    ~StatementPool();
+
+    // returns an idle handle, or allocates a new one if there is none
+    SQLRETURN Checkout(SQLHSTMT *hSTMT);
+
+    // resets a checked out handle and keeps it for reuse
+    void Return(SQLHSTMT hSTMT);
+
+    // frees a checked out handle instead of keeping it
+    void Free(SQLHSTMT hSTMT);
+
+    // frees all idle handles; handles returned later are left to SQLDisconnect
+    void Close();
+
+    // how many handles are checked out, for connection.reset(). They are
+    // left alone: another worker may still be executing or fetching on them
+    size_t CheckedOut();
+
+    unsigned int MaxIdle();
+    void SetMaxIdle(unsigned int maxIdle);
+
+    Napi::Object Stats(Napi::Env env);
+
+  private:
+    void FreeHandles(std::vector<SQLHSTMT> *handles);
+
+    SQLHDBC      hDBC;
+    std::shared_ptr<HandleLock> lock;
+    unsigned int maxIdle;
+    bool         closed;
+
+    std::vector<SQLHSTMT> idle;
+    std::unordered_set<SQLHSTMT> checkedOut;
+
+    uv_mutex_t mutex;
+
+    uint64_t outstanding;
+    uint64_t allocations;
+    uint64_t reuses;
+    uint64_t discards;
+};
+
+#endif
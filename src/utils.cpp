@@ -1,4 +1,10 @@
 #include "utils.h"
+#include "odbc.h"
+#include "parameter_stream.h"
+#include "query_canceller.h"
+#include "statement_cache.h"
+#include "statement_pool.h"
+#include "metrics.h"
 
 Napi::Value EmptyCallback(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
@@ -24,6 +30,7 @@ void FetchData(QueryData *data) {
 
   if (SQL_SUCCEEDED(SQLFetch(data->hSTMT))) {
 
+    uint64_t bytes = 0;
     ColumnData *row = new ColumnData[data->columnCount];
 
     // Iterate over each column, putting the data in the row object
@@ -36,14 +43,21 @@ void FetchData(QueryData *data) {
       } else {
         row[i].data = new SQLTCHAR[row[i].size];
         memcpy(row[i].data, data->boundRow[i], row[i].size);
+        bytes += row[i].size;
       }
     }
 
     data->storedRows.push_back(row);
+
+    Metrics::Fetched(1, bytes);
   }
 }
 
 void FetchAllData(QueryData *data) {
+
+  uint64_t rows = 0;
+  uint64_t bytes = 0;
+
   // continue call SQLFetch, with results going in the boundRow array
   while(SQL_SUCCEEDED(SQLFetch(data->hSTMT))) {
 
@@ -59,11 +73,17 @@ void FetchAllData(QueryData *data) {
       } else {
         row[i].data = new SQLTCHAR[row[i].size];
         memcpy(row[i].data, data->boundRow[i], row[i].size);
+        bytes += row[i].size;
       }
     }
 
     data->storedRows.push_back(row);
+    rows++;
   }
+
+  data->timings.fetched = uv_hrtime();
+
+  Metrics::Fetched(rows, bytes);
 }
 
 void BindColumns(QueryData *data) {
@@ -178,6 +198,8 @@ void BindColumns(QueryData *data) {
       return;
     }
   }
+
+  data->timings.bound = uv_hrtime();
 }
 
 void BindParameters(QueryData *data) {
@@ -208,6 +230,333 @@ void BindParameters(QueryData *data) {
   }
 }
 
+void FreeParameters(Parameter *params, int paramCount) {
+
+  Parameter prm;
+
+  for (int i = 0; i < paramCount; i++) {
+    if (prm = params[i], prm.ParameterValuePtr != NULL) {
+      switch (prm.ValueType) {
+        case SQL_C_WCHAR:   free(prm.ParameterValuePtr);             break;
+        case SQL_C_CHAR:    free(prm.ParameterValuePtr);             break;
+        case SQL_C_LONG:    delete (int64_t *)prm.ParameterValuePtr; break;
+        case SQL_C_SBIGINT: delete (int64_t *)prm.ParameterValuePtr; break;
+        case SQL_C_DOUBLE:  delete (double  *)prm.ParameterValuePtr; break;
+        case SQL_C_BIT:     delete (bool    *)prm.ParameterValuePtr; break;
+      }
+    }
+
+    delete prm.stream;
+    delete prm.reference;
+  }
+
+  free(params);
+}
+
+// Reads the options object of query() and queryAll():
+//   timeout:   SQL_ATTR_QUERY_TIMEOUT for the statement, in seconds
+//   signal:    an AbortSignal that cancels the query with SQLCancel
+//   fetchMode: rows as objects or arrays
+// Returns false if the signal has already aborted.
+bool GetQueryOptions(Napi::Env env, Napi::Value value, QueryData *data) {
+
+  if (!value.IsObject() || value.IsArray()) {
+    return true;
+  }
+
+  Napi::Object options = value.As<Napi::Object>();
+
+  Napi::Value timeout = options.Get("timeout");
+
+  if (timeout.IsNumber()) {
+    data->queryTimeout = timeout.As<Napi::Number>().Uint32Value();
+  }
+
+  Napi::Value fetchMode = options.Get("fetchMode");
+
+  if (fetchMode.IsNumber()) {
+    data->fetchMode = fetchMode.As<Napi::Number>().Int32Value();
+  }
+
+  Napi::Value signal = options.Get("signal");
+
+  if (signal.IsObject()) {
+
+    if (signal.As<Napi::Object>().Get("aborted").ToBoolean().Value()) {
+      return false;
+    }
+
+    data->canceller = std::make_shared<QueryCanceller>();
+    data->canceller->Listen(env, signal.As<Napi::Object>());
+
+    // a worker waiting on a parameter stream isn't in the driver, SQLCancel
+    // alone wouldn't reach it
+    for (int i = 0; i < data->paramCount; i++) {
+      ParameterStream *stream = data->params[i].stream;
+
+      if (stream != NULL) {
+        data->canceller->OnCancel([stream]() { stream->Cancel(); });
+      }
+    }
+  }
+
+  return true;
+}
+
+// The rejection for a query cancelled through its AbortSignal before it ran
+Napi::Object GetAbortError(Napi::Env env) {
+
+  Napi::Object error = Napi::Error::New(env, "[node-odbc] The query was aborted").Value();
+  error.Set(Napi::String::New(env, "name"), Napi::String::New(env, "AbortError"));
+  error.Set(Napi::String::New(env, "cancelled"), Napi::Boolean::New(env, true));
+
+  return error;
+}
+
+// The rejection for a failed query: the error of a failed parameter stream,
+// or the statement's diagnostics, marked as cancelled (AbortError) or timed
+// out (SQLSTATE HYT00) when that is why it failed.
+Napi::Value GetQueryError(Napi::Env env, QueryData *data, const char *message) {
+
+  Napi::Value streamError = GetParameterStreamError(env, data);
+
+  if (!streamError.IsUndefined()) {
+    return streamError;
+  }
+
+  Napi::Object error = GetSQLError(env, SQL_HANDLE_STMT, data->hSTMT, message);
+  error.Set(Napi::String::New(env, "timings"), GetQueryTimings(env, data));
+
+  if (data->canceller && data->canceller->Cancelled()) {
+    error.Set(Napi::String::New(env, "name"), Napi::String::New(env, "AbortError"));
+    error.Set(Napi::String::New(env, "cancelled"), Napi::Boolean::New(env, true));
+  } else if (error.Get("state").IsString() && error.Get("state").As<Napi::String>().Utf8Value() == "HYT00") {
+    error.Set(Napi::String::New(env, "timedOut"), Napi::Boolean::New(env, true));
+  }
+
+  return error;
+}
+
+// data->timings as milliseconds since the query was queued, leaving out the
+// steps it didn't go through, plus the total up to the last step.
+Napi::Object GetQueryTimings(Napi::Env env, QueryData *data) {
+
+  QueryTimings *timings = &(data->timings);
+  Napi::Object result = Napi::Object::New(env);
+
+  const char *names[] = { "queued", "started", "allocated", "executed", "bound",
+                          "fetchQueued", "fetchStarted", "fetched", "materialized" };
+  uint64_t stamps[] = { timings->queued, timings->started, timings->allocated, timings->executed, timings->bound,
+                        timings->fetchQueued, timings->fetchStarted, timings->fetched, timings->materialized };
+
+  uint64_t origin = timings->queued;
+  uint64_t last = origin;
+
+  for (size_t i = 0; i < sizeof(stamps) / sizeof(stamps[0]); i++) {
+    if (stamps[i] == 0 || stamps[i] < origin) {
+      continue;
+    }
+
+    result.Set(names[i], Napi::Number::New(env, (stamps[i] - origin) / 1e6));
+
+    if (stamps[i] > last) {
+      last = stamps[i];
+    }
+  }
+
+  result.Set("total", Napi::Number::New(env, (last - origin) / 1e6));
+
+  return result;
+}
+
+void SetQueryTimeout(QueryData *data) {
+
+  if (data->queryTimeout > 0) {
+    SQLSetStmtAttr(data->hSTMT, SQL_ATTR_QUERY_TIMEOUT, (SQLPOINTER) data->queryTimeout, SQL_IS_UINTEGER);
+  }
+}
+
+// Runs data->sql on a statement handle from the prepared statement cache, or
+// from the connection's statement pool if the query is not cached, and binds
+// the result set columns. Returns the return code of the execution, which is
+// also left in data->sqlReturnCode unless binding the columns failed.
+SQLRETURN ExecuteQuery(QueryData *data) {
+
+  if (data->statementCache) {
+
+    // take a prepared handle for this SQL out of the connection's cache
+    data->sqlReturnCode = data->statementCache->Acquire(data->sql, &(data->hSTMT));
+
+    if (!SQL_SUCCEEDED(data->sqlReturnCode)) {
+      return data->sqlReturnCode;
+    }
+
+    data->timings.allocated = uv_hrtime();
+
+    // binds all parameters to the query
+    BindParameters(data);
+
+    SetQueryTimeout(data);
+
+    // execute the prepared statement
+    if (!data->canceller || data->canceller->Begin(data->hSTMT)) {
+      data->sqlReturnCode = SQLExecute(data->hSTMT);
+    } else {
+      data->sqlReturnCode = SQL_ERROR;
+    }
+
+  } else {
+
+    // take a statement handle from the connection's pool, unless the caller
+    // already did
+    if (data->hSTMT == SQL_NULL_HSTMT) {
+      data->sqlReturnCode = data->statementPool->Checkout(&(data->hSTMT));
+
+      if (!SQL_SUCCEEDED(data->sqlReturnCode)) {
+        return data->sqlReturnCode;
+      }
+    }
+
+    data->timings.allocated = uv_hrtime();
+
+    if (data->paramCount > 0) {
+      // binds all parameters to the query
+      BindParameters(data);
+    }
+
+    SetQueryTimeout(data);
+
+    // execute the query directly
+    if (!data->canceller || data->canceller->Begin(data->hSTMT)) {
+      data->sqlReturnCode = SQLExecDirect(
+        data->hSTMT,
+        data->sql,
+        SQL_NTS
+      );
+    } else {
+      data->sqlReturnCode = SQL_ERROR;
+    }
+  }
+
+  if (data->sqlReturnCode == SQL_NEED_DATA) {
+    // send the streamed parameters
+    data->sqlReturnCode = PutStreamedParameters(data);
+  }
+
+  if (data->canceller) {
+    data->canceller->End();
+  }
+
+  data->timings.executed = uv_hrtime();
+
+  SQLRETURN sqlReturnCode = data->sqlReturnCode;
+
+  if (SQL_SUCCEEDED(sqlReturnCode)) {
+    BindColumns(data);
+  }
+
+  return sqlReturnCode;
+}
+
+// Gives data->hSTMT back to wherever it came from: the prepared statement
+// cache, the connection's statement pool, or SQLFreeHandle if it was allocated
+// directly.
+SQLRETURN ReleaseStatement(QueryData *data) {
+
+  SQLRETURN sqlReturnCode = SQL_SUCCESS;
+
+  if (data->hSTMT == SQL_NULL_HSTMT) {
+    return sqlReturnCode;
+  }
+
+  // the next user of the handle expects it to block, with no timeout
+  if (data->asyncExecution) {
+    SQLSetStmtAttr(data->hSTMT, SQL_ATTR_ASYNC_ENABLE, (SQLPOINTER) SQL_ASYNC_ENABLE_OFF, SQL_IS_UINTEGER);
+    data->asyncExecution = false;
+  }
+
+  if (data->queryTimeout > 0) {
+    SQLSetStmtAttr(data->hSTMT, SQL_ATTR_QUERY_TIMEOUT, (SQLPOINTER) 0, SQL_IS_UINTEGER);
+  }
+
+  if (data->statementCache) {
+    data->statementCache->Release(data->hSTMT);
+    data->statementCache.reset();
+  } else if (data->statementPool) {
+    data->statementPool->Return(data->hSTMT);
+    data->statementPool.reset();
+  } else {
+    data->connectionLock->Lock();
+    sqlReturnCode = SQLFreeHandle(SQL_HANDLE_STMT, data->hSTMT);
+    data->connectionLock->Unlock();
+  }
+
+  data->hSTMT = SQL_NULL_HSTMT;
+
+  return sqlReturnCode;
+}
+
+// Called after SQLExecute or SQLExecDirect returned SQL_NEED_DATA. Sends the
+// data for every data-at-execution parameter with SQLPutData, one chunk at a
+// time, and returns the final return code of the execution.
+SQLRETURN PutStreamedParameters(QueryData *data) {
+
+  SQLRETURN sqlReturnCode;
+  SQLPOINTER token;
+
+  while ((sqlReturnCode = SQLParamData(data->hSTMT, &token)) == SQL_NEED_DATA) {
+
+    // ParameterValuePtr of a data-at-execution parameter is its stream
+    ParameterStream *stream = (ParameterStream *) token;
+
+    SQLPOINTER chunk;
+    SQLLEN chunkLength;
+    bool empty = true;
+
+    while (stream->Next(&chunk, &chunkLength)) {
+
+      empty = false;
+
+      sqlReturnCode = SQLPutData(data->hSTMT, chunk, chunkLength);
+
+      if (!SQL_SUCCEEDED(sqlReturnCode)) {
+        // leave the diagnostic records in place for GetSQLError
+        stream->Cancel();
+        return sqlReturnCode;
+      }
+    }
+
+    if (stream->Failed() || stream->Cancelled()) {
+      // the JavaScript side failed or the query was aborted, abandon the
+      // execution
+      SQLCancel(data->hSTMT);
+      return SQL_ERROR;
+    }
+
+    if (empty) {
+      // an empty stream is a zero-length value, not NULL
+      sqlReturnCode = SQLPutData(data->hSTMT, (SQLPOINTER) "", 0);
+
+      if (!SQL_SUCCEEDED(sqlReturnCode)) {
+        return sqlReturnCode;
+      }
+    }
+  }
+
+  return sqlReturnCode;
+}
+
+Napi::Value GetParameterStreamError(Napi::Env env, QueryData *data) {
+
+  for (int i = 0; i < data->paramCount; i++) {
+    if (data->params[i].stream != NULL && data->params[i].stream->Failed()) {
+      return data->params[i].stream->Error(env);
+    }
+  }
+
+  return env.Undefined();
+}
+
 Parameter* GetParametersFromArray(Napi::Array *values, int *paramCount) {
 
   DEBUG_PRINTF("GetParametersFromArray\n");
@@ -232,6 +581,8 @@ Parameter* GetParametersFromArray(Napi::Array *values, int *paramCount) {
     params[i].StrLen_or_IndPtr = SQL_NULL_DATA;
     params[i].BufferLength     = 0;
     params[i].DecimalDigits    = 0;
+    params[i].stream           = NULL;
+    params[i].reference        = NULL;
 
     value = param;
     params[i].InputOutputType = SQL_PARAM_INPUT_OUTPUT;
@@ -336,16 +687,22 @@ Napi::Object GetSQLError(Napi::Env env, SQLSMALLINT handleType, SQLHANDLE handle
 Napi::Object GetSQLError(Napi::Env env, SQLSMALLINT handleType, SQLHANDLE handle, const char* message) {
   DEBUG_PRINTF("GetSQLError : handleType=%i, handle=%p\n", handleType, handle);
 
-  Napi::Object objError = Napi::Object::New(env);
+  std::vector<DiagnosticRecord> records;
+
+  CaptureSQLError(handleType, handle, &records);
+
+  return GetSQLError(env, &records, message);
+}
+
+// Copies the diagnostic records of a handle. Doesn't touch JavaScript, so it
+// can be called from a worker thread before the handle is reused or freed.
+void CaptureSQLError(SQLSMALLINT handleType, SQLHANDLE handle, std::vector<DiagnosticRecord> *records) {
 
-  int32_t i = 0;
   SQLINTEGER native;
 
   SQLSMALLINT len;
-  SQLINTEGER statusRecCount;
+  SQLINTEGER statusRecCount = 0;
   SQLRETURN ret;
-  char errorSQLState[14];
-  char errorMessage[ERROR_MESSAGE_BUFFER_BYTES];
 
   ret = SQLGetDiagField(
     handleType,
@@ -357,62 +714,73 @@ Napi::Object GetSQLError(Napi::Env env, SQLSMALLINT handleType, SQLHANDLE handle
     &len);
 
   // Windows seems to define SQLINTEGER as long int, unixodbc as just int... %i should cover both
-  DEBUG_PRINTF("GetSQLError : called SQLGetDiagField; ret=%i, statusRecCount=%i\n", ret, statusRecCount);
-
-  Napi::Array errors = Napi::Array::New(env);
+  DEBUG_PRINTF("CaptureSQLError : called SQLGetDiagField; ret=%i, statusRecCount=%i\n", ret, statusRecCount);
 
-  objError.Set(Napi::String::New(env, "errors"), errors);
+  for (int32_t i = 0; i < statusRecCount; i++) {
 
-  for (i = 0; i < statusRecCount; i++){
+    DEBUG_PRINTF("CaptureSQLError : calling SQLGetDiagRec; i=%i, statusRecCount=%i\n", i, statusRecCount);
 
-    DEBUG_PRINTF("GetSQLError : calling SQLGetDiagRec; i=%i, statusRecCount=%i\n", i, statusRecCount);
+    DiagnosticRecord record;
 
     ret = SQLGetDiagRec(
       handleType,
       handle,
       (SQLSMALLINT)(i + 1),
-      (SQLTCHAR *) errorSQLState,
+      record.state,
       &native,
-      (SQLTCHAR *) errorMessage,
+      record.message,
       ERROR_MESSAGE_BUFFER_CHARS,
       &len);
 
-    DEBUG_PRINTF("GetSQLError : after SQLGetDiagRec; i=%i\n", i);
+    DEBUG_PRINTF("CaptureSQLError : after SQLGetDiagRec; i=%i\n", i);
 
     if (SQL_SUCCEEDED(ret)) {
-      DEBUG_PRINTF("GetSQLError : errorMessage=%s, errorSQLState=%s\n", errorMessage, errorSQLState);
+      records->push_back(record);
+    } else if (ret == SQL_NO_DATA) {
+      break;
+    }
+  }
+}
 
-      if (i == 0) {
-        // First error is assumed the primary error
-        objError.Set(Napi::String::New(env, "error"), Napi::String::New(env, message));
-#ifdef UNICODE
-        //objError.SetPrototype(Exception::Error(Napi::String::New(env, (char16_t *) errorMessage)));
-        objError.Set(Napi::String::New(env, "message"), Napi::String::New(env, (char16_t *) errorMessage));
-        objError.Set(Napi::String::New(env, "state"), Napi::String::New(env, (char16_t *) errorSQLState));
-#else
-        //objError.SetPrototype(Exception::Error(Napi::String::New(env, errorMessage)));
-        objError.Set(Napi::String::New(env, "message"), Napi::String::New(env, errorMessage));
-        objError.Set(Napi::String::New(env, "state"), Napi::String::New(env, errorSQLState));
-#endif
-      }
+// Builds the error object for diagnostic records taken with CaptureSQLError
+Napi::Object GetSQLError(Napi::Env env, std::vector<DiagnosticRecord> *records, const char* message) {
+
+  Napi::Object objError = Napi::Object::New(env);
+
+  Napi::Array errors = Napi::Array::New(env);
 
-      Napi::Object subError = Napi::Object::New(env);
+  objError.Set(Napi::String::New(env, "errors"), errors);
+
+  for (size_t i = 0; i < records->size(); i++) {
+
+    DiagnosticRecord *record = &(*records)[i];
+
+    DEBUG_PRINTF("GetSQLError : errorMessage=%s, errorSQLState=%s\n", record->message, record->state);
 
 #ifdef UNICODE
-      subError.Set(Napi::String::New(env, "message"), Napi::String::New(env, (char16_t *) errorMessage));
-      subError.Set(Napi::String::New(env, "state"), Napi::String::New(env, (char16_t *) errorSQLState));
+    Napi::String errorMessage = Napi::String::New(env, (char16_t *) record->message);
+    Napi::String errorSQLState = Napi::String::New(env, (char16_t *) record->state);
 #else
-      subError.Set(Napi::String::New(env, "message"), Napi::String::New(env, errorMessage));
-      subError.Set(Napi::String::New(env, "state"), Napi::String::New(env, errorSQLState));
+    Napi::String errorMessage = Napi::String::New(env, (char *) record->message);
+    Napi::String errorSQLState = Napi::String::New(env, (char *) record->state);
 #endif
-      errors.Set(Napi::String::New(env, std::to_string(i)), subError);
 
-    } else if (ret == SQL_NO_DATA) {
-      break;
+    if (i == 0) {
+      // First error is assumed the primary error
+      objError.Set(Napi::String::New(env, "error"), Napi::String::New(env, message));
+      objError.Set(Napi::String::New(env, "message"), errorMessage);
+      objError.Set(Napi::String::New(env, "state"), errorSQLState);
     }
+
+    Napi::Object subError = Napi::Object::New(env);
+
+    subError.Set(Napi::String::New(env, "message"), errorMessage);
+    subError.Set(Napi::String::New(env, "state"), errorSQLState);
+
+    errors.Set(Napi::String::New(env, std::to_string(i)), subError);
   }
 
-  if (statusRecCount == 0) {
+  if (records->empty()) {
     //Create a default error object if there were no diag records
     objError.Set(Napi::String::New(env, "error"), Napi::String::New(env, message));
     //objError.SetPrototype(Napi::Error(Napi::String::New(env, message)));
@@ -478,6 +846,61 @@ void DetermineParameterType(Napi::Value value, Parameter *param) {
                   i, param->ValueType, param->ParameterType,
                   param->BufferLength, param->ColumnSize, param->StrLen_or_IndPtr);
   }
+  else if (value.IsTypedArray() || value.IsArrayBuffer()) {
+    // Buffer, any TypedArray or an ArrayBuffer: the bytes are bound where they
+    // are, the reference keeps them alive until the parameters are freed
+    SQLPOINTER bytes;
+    size_t length;
+
+    if (value.IsTypedArray()) {
+      Napi::TypedArray typedArray = value.As<Napi::TypedArray>();
+      bytes = (char *) typedArray.ArrayBuffer().Data() + typedArray.ByteOffset();
+      length = typedArray.ByteLength();
+    } else {
+      Napi::ArrayBuffer arrayBuffer = value.As<Napi::ArrayBuffer>();
+      bytes = arrayBuffer.Data();
+      length = arrayBuffer.ByteLength();
+    }
+
+    // some drivers reject a NULL buffer even when its length is 0
+    static char emptyBinary[1] = { 0 };
+
+    param->InputOutputType   = SQL_PARAM_INPUT; // never written back into JS memory
+    param->ValueType         = SQL_C_BINARY;
+    param->ParameterType     = length > MAX_VARBINARY_SIZE ? SQL_LONGVARBINARY : SQL_VARBINARY;
+    param->ColumnSize        = length > 0 ? length : 1;
+    param->ParameterValuePtr = length > 0 ? bytes : emptyBinary;
+    param->BufferLength      = length;
+    param->StrLen_or_IndPtr  = length;
+    param->reference         = new Napi::ObjectReference(Napi::Persistent(value.As<Napi::Object>()));
+
+    DEBUG_PRINTF("GetParametersFromArray - IsBinary(): params[%i] c_type=%i type=%i buffer_length=%lli size=%lli length=%lli\n",
+                  i, param->ValueType, param->ParameterType,
+                  param->BufferLength, param->ColumnSize, param->StrLen_or_IndPtr);
+  }
+  else if (ParameterStream::IsStreamable(value.Env(), value)) {
+    // an async iterable, e.g. a Readable stream: the data is sent in chunks
+    // with SQLPutData once the driver asks for it (see PutStreamedParameters)
+    param->stream = ParameterStream::FromIterable(value.Env(), value);
+
+    if (param->stream == NULL) {
+      param->ValueType        = SQL_C_DEFAULT;
+      param->ParameterType    = SQL_VARCHAR;
+      param->StrLen_or_IndPtr = SQL_NULL_DATA;
+      return;
+    }
+
+    param->InputOutputType   = SQL_PARAM_INPUT;
+    param->ValueType         = SQL_C_BINARY;
+    param->ParameterType     = SQL_LONGVARBINARY;
+    param->ColumnSize        = 0;
+    param->ParameterValuePtr = param->stream; // handed back by SQLParamData
+    param->BufferLength      = 0;
+    param->StrLen_or_IndPtr  = SQL_LEN_DATA_AT_EXEC(0);
+
+    DEBUG_PRINTF("GetParametersFromArray - IsStreamable(): params[%i] c_type=%i type=%i\n",
+                  i, param->ValueType, param->ParameterType);
+  }
   else { // Default to string
 
     Napi::String string = value.ToString();
@@ -16,6 +16,24 @@ void BindColumns(QueryData *data);
 
 void BindParameters(QueryData *data);
 
+SQLRETURN PutStreamedParameters(QueryData *data);
+
+Napi::Value GetParameterStreamError(Napi::Env env, QueryData *data);
+
+bool GetQueryOptions(Napi::Env env, Napi::Value value, QueryData *data);
+
+Napi::Object GetAbortError(Napi::Env env);
+
+Napi::Value GetQueryError(Napi::Env env, QueryData *data, const char *message);
+
+Napi::Object GetQueryTimings(Napi::Env env, QueryData *data);
+
+void SetQueryTimeout(QueryData *data);
+
+SQLRETURN ExecuteQuery(QueryData *data);
+
+SQLRETURN ReleaseStatement(QueryData *data);
+
 Parameter* GetParametersFromArray(Napi::Array *values, int *paramCount);
 
 Napi::Array GetNapiRowData(Napi::Env env, std::vector<ColumnData*> *storedRows, Column *columns, int columnCount, int fetchMode);
@@ -24,6 +42,10 @@ Napi::Object GetSQLError(Napi::Env env, SQLSMALLINT handleType, SQLHANDLE handle
 
 Napi::Object GetSQLError(Napi::Env env, SQLSMALLINT handleType, SQLHANDLE handle, const char* message);
 
+void CaptureSQLError(SQLSMALLINT handleType, SQLHANDLE handle, std::vector<DiagnosticRecord> *records);
+
+Napi::Object GetSQLError(Napi::Env env, std::vector<DiagnosticRecord> *records, const char* message);
+
 void DetermineParameterType(Napi::Value value, Parameter *param);
 
 #endif
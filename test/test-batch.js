@@ -0,0 +1,52 @@
+var common = require("./common")
+  , odbc = require("../")
+  , db = new odbc.Database()
+  , assert = require("assert");
+
+db.open(common.connectionString)
+  .then(function () {
+    return db.batch([
+      "drop table if exists " + common.tableName,
+      "create table " + common.tableName + " (COLINT INTEGER, COLDATETIME DATETIME, COLTEXT TEXT)",
+      { sql: "insert into " + common.tableName + " (COLINT, COLTEXT) values (?, ?)", params: [1, "one"] },
+      { sql: "insert into " + common.tableName + " (COLINT, COLTEXT) values (?, ?)", params: [2, "two"] },
+      "select COLINT, COLTEXT from " + common.tableName + " order by COLINT"
+    ]);
+  })
+  .then(function (results) {
+    assert.equal(results.length, 5);
+    assert.equal(results[2], 1);
+    assert.equal(results[3], 1);
+    assert.deepEqual(results[4], [{ COLINT: 1, COLTEXT: "one" }, { COLINT: 2, COLTEXT: "two" }]);
+
+    // keeps going past the bad statement, which gets its error in place
+    return db.batch([
+      "select bogus from nowhere",
+      "delete from " + common.tableName
+    ], { stopOnError: false });
+  })
+  .then(function (results) {
+    assert.ok(results[0].message);
+    assert.equal(results[1], 2);
+
+    return db.batch([
+      "select 1",
+      "select bogus from nowhere",
+      "drop table " + common.tableName
+    ]).then(function () {
+      assert.fail("batch should have been rejected");
+    }, function (err) {
+      assert.equal(err.index, 1);
+      assert.equal(err.results.length, 1);
+    });
+  })
+  .then(function () {
+    return db.batch(["drop table " + common.tableName]);
+  })
+  .then(function () {
+    return db.close();
+  })
+  .catch(function (err) {
+    console.error(err);
+    process.exit(1);
+  });
@@ -0,0 +1,28 @@
+var common = require("./common")
+  , odbc = require("../")
+  , assert = require("assert");
+
+// eight logins, four at a time, on the libuv threadpool like any other work
+odbc.connectMany(common.connectionString, 8, { concurrency: 4 })
+  .then(function (databases) {
+    assert.equal(databases.length, 8);
+    assert.equal(databases[0].threadPoolStats, undefined);
+
+    return Promise.all(databases.map(function (db, i) {
+      return db.queryAll("select ? as \"COLINT\"", [i]).then(function (rows) {
+        assert.deepEqual(rows, [{ COLINT: i }]);
+        return db.close();
+      });
+    }));
+  })
+  .then(function () {
+    return odbc.connectMany("DSN=doesNotExist", 3).then(function () {
+      assert.fail("connectMany should have failed");
+    }, function (err) {
+      assert.ok(err);
+    });
+  })
+  .catch(function (err) {
+    console.error(err);
+    process.exit(1);
+  });
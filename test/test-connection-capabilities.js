@@ -0,0 +1,27 @@
+var common = require("./common")
+  , odbc = require("../")
+  , db = new odbc.Database()
+  , assert = require("assert");
+
+assert.equal(db.capabilities, undefined);
+
+// read once at open, then available without a trip to the driver
+db.open(common.connectionString)
+  .then(function () {
+    var capabilities = db.capabilities;
+
+    assert.equal(typeof capabilities.driverName, "string");
+    assert.ok(capabilities.driverName.length > 0);
+    assert.equal(typeof capabilities.dbmsName, "string");
+    assert.equal(typeof capabilities.maxConcurrentActivities, "number");
+    assert.ok(Array.isArray(capabilities.scrollOptions));
+    assert.ok(["none", "connection", "statement"].indexOf(capabilities.asyncMode) !== -1);
+    assert.ok(["none", "batch", "noBatch"].indexOf(capabilities.paramArrayRowCounts) !== -1);
+    assert.equal(typeof capabilities.moreResults, "boolean");
+
+    return db.close();
+  })
+  .catch(function (err) {
+    console.error(err);
+    process.exit(1);
+  });
@@ -0,0 +1,45 @@
+var common = require("./common")
+  , odbc = require("../")
+  , db = new odbc.Database({ dedicatedThread: true })
+  , assert = require("assert");
+
+// everything on the connection, including its statements and results, runs on
+// the connection's own thread; the results must not change
+db.open(common.connectionString)
+  .then(function () {
+    assert.equal(db.co.dedicatedThread, true);
+
+    return Promise.all([
+      db.queryAll("select ? as \"COLINT\"", [1]),
+      db.queryAll("select ? as \"COLINT\"", [2]),
+      db.queryAll("select ? as \"COLINT\"", [3])
+    ]);
+  })
+  .then(function (results) {
+    assert.deepEqual(results, [[{ COLINT: 1 }], [{ COLINT: 2 }], [{ COLINT: 3 }]]);
+
+    return db.co.createStatement();
+  })
+  .then(function (stmt) {
+    return stmt.prepare("select ? as \"COLINT\"")
+      .then(function () { return stmt.bind([4]); })
+      .then(function () { return stmt.execute(); })
+      .then(function (result) { return result.fetchAll(); })
+      .then(function (data) {
+        assert.deepEqual(data, [{ COLINT: 4 }]);
+      });
+  })
+  .then(function () {
+    return db.queryAll("select bogus from nowhere").then(function () {
+      assert.fail("query should have been rejected");
+    }, function (err) {
+      assert.ok(err.message);
+    });
+  })
+  .then(function () {
+    return db.close();
+  })
+  .catch(function (err) {
+    console.error(err);
+    process.exit(1);
+  });
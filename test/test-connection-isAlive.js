@@ -0,0 +1,37 @@
+var common = require("./common")
+  , odbc = require("../")
+  , db = new odbc.Database()
+  , assert = require("assert");
+
+db.open(common.connectionString)
+  .then(function () {
+    return db.isAlive();
+  })
+  .then(function (alive) {
+    assert.equal(alive, true);
+
+    return db.close();
+  })
+  .then(function () {
+    return db.isAlive();
+  })
+  .then(function (alive) {
+    assert.equal(alive, false);
+
+    // pooled connections are checked before they are handed out
+    return odbc.pool({ connectionString: common.connectionString, min: 1, validateOnBorrow: true });
+  })
+  .then(function (pool) {
+    return pool.acquire().then(function (db) {
+      assert.equal(pool.stats.validations, 1);
+      assert.equal(pool.stats.validationFailures, 0);
+
+      return db.close();
+    }).then(function () {
+      return pool.close();
+    });
+  })
+  .catch(function (err) {
+    console.error(err);
+    process.exit(1);
+  });
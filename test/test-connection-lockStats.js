@@ -0,0 +1,38 @@
+var common = require("./common")
+  , odbc = require("../")
+  , db = new odbc.Database()
+  , serialized = new odbc.Database({ globalLock: true })
+  , assert = require("assert");
+
+function assertStats(stats) {
+  assert.ok(stats.acquisitions > 0);
+  assert.ok(stats.contended <= stats.acquisitions);
+  assert.ok(stats.waitTime >= 0);
+  assert.ok(stats.maxWaitTime <= stats.waitTime);
+}
+
+// each connection has a lock of its own, unless its environment asked for the
+// old process wide one
+Promise.all([db.open(common.connectionString), serialized.open(common.connectionString)])
+  .then(function () {
+    return Promise.all([
+      db.queryAll("select ? as \"COLINT\"", [1]),
+      serialized.queryAll("select ? as \"COLINT\"", [2])
+    ]);
+  })
+  .then(function (results) {
+    assert.deepEqual(results, [[{ COLINT: 1 }], [{ COLINT: 2 }]]);
+
+    assertStats(db.lockStats);
+    assertStats(serialized.lockStats);
+    assertStats(db.odbc.lockStats);
+
+    // the serialized environment and its connection share one lock
+    assert.deepEqual(serialized.odbc.lockStats, serialized.lockStats);
+
+    return Promise.all([db.close(), serialized.close()]);
+  })
+  .catch(function (err) {
+    console.error(err);
+    process.exit(1);
+  });
@@ -0,0 +1,55 @@
+var common = require("./common")
+  , odbc = require("../")
+  , assert = require("assert");
+
+var options = { connectionPooling: "driver", poolMatch: "relaxed" };
+
+assert.throws(function () {
+  new odbc.Database({ connectionPooling: "sometimes" });
+});
+
+// every short lived Database gets its connection from the driver manager's
+// pool after the first one
+function openQueryClose(i) {
+  var db = new odbc.Database(options);
+
+  return db.open(common.connectionString)
+    .then(function () {
+      assert.equal(db.odbc.connectionPooling, "driver");
+      return db.queryAll("select ? as \"COLINT\"", [i]);
+    })
+    .then(function (rows) {
+      assert.deepEqual(rows, [{ COLINT: i }]);
+      return db.close();
+    });
+}
+
+// environments allocated before pooling was turned on aren't pooled, so a
+// pooled Database mustn't get the shared environment of earlier ones
+var unpooled = [new odbc.Database(), new odbc.Database(), new odbc.Database()]
+  , pooled;
+
+var chain = Promise.all(unpooled.map(function (db) {
+  return db.open(common.connectionString);
+}))
+  .then(function () {
+    pooled = new odbc.Database(options);
+    return pooled.open(common.connectionString);
+  })
+  .then(function () {
+    assert.deepEqual(unpooled[1].odbc.lockStats, unpooled[0].odbc.lockStats);
+    assert.ok(pooled.odbc.lockStats.acquisitions < unpooled[0].odbc.lockStats.acquisitions);
+
+    return Promise.all(unpooled.concat(pooled).map(function (db) {
+      return db.close();
+    }));
+  });
+
+for (var i = 0; i < 5; i++) {
+  chain = chain.then(openQueryClose.bind(null, i));
+}
+
+chain.catch(function (err) {
+  console.error(err);
+  process.exit(1);
+});
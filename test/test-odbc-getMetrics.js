@@ -0,0 +1,37 @@
+var common = require("./common")
+  , odbc = require("../")
+  , db = new odbc.Database()
+  , assert = require("assert");
+
+var before = odbc.getMetrics();
+
+// every operation lands in its histogram, and the rows in the totals
+db.open(common.connectionString)
+  .then(function () {
+    return db.queryAll("select 1 as \"COLINT\" union all select 2");
+  })
+  .then(function (rows) {
+    assert.equal(rows.length, 2);
+    return db.transaction(["select 1 as \"COLINT\""]);
+  })
+  .then(function () {
+    return db.close();
+  })
+  .then(function () {
+    var metrics = odbc.getMetrics();
+    var open = metrics.operations.open;
+    var query = metrics.operations.query;
+
+    assert.equal(open.count, before.operations.open.count + 1);
+    assert.equal(query.count, before.operations.query.count + 2);
+    assert.ok(query.p50 <= query.p99);
+    assert.ok(query.p99 <= query.max);
+    assert.ok(metrics.rows >= before.rows + 2);
+    assert.ok(metrics.bytes > before.bytes);
+    assert.equal(typeof metrics.inFlight, "number");
+    assert.ok(Array.isArray(metrics.pools));
+  })
+  .catch(function (err) {
+    console.error(err);
+    process.exit(1);
+  });
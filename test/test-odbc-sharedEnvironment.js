@@ -0,0 +1,32 @@
+var common = require("./common")
+  , odbc = require("../")
+  , assert = require("assert");
+
+// Databases share one environment, and so the lock around its connection
+// handles, unless they ask for one of their own
+var first = new odbc.Database()
+  , second = new odbc.Database()
+  , own = new odbc.Database({ sharedEnvironment: false });
+
+assert.throws(function () {
+  new odbc.Database({ sharedEnvironment: "sometimes" });
+});
+
+Promise.all([
+  first.open(common.connectionString),
+  second.open(common.connectionString),
+  own.open(common.connectionString)
+])
+  .then(function () {
+    var shared = first.odbc.lockStats;
+
+    assert.ok(shared.acquisitions >= 2);
+    assert.deepEqual(second.odbc.lockStats, shared);
+    assert.ok(own.odbc.lockStats.acquisitions < shared.acquisitions);
+
+    return Promise.all([first.close(), second.close(), own.close()]);
+  })
+  .catch(function (err) {
+    console.error(err);
+    process.exit(1);
+  });
@@ -0,0 +1,35 @@
+var common = require("./common")
+  , odbc = require("../")
+  , db = new odbc.Database({ threadPoolSize: 4 })
+  , assert = require("assert");
+
+// the connection's work runs on the environment's own four threads
+db.open(common.connectionString)
+  .then(function () {
+    var queries = [];
+
+    for (var i = 0; i < 16; i++) {
+      queries.push(db.queryAll("select ? as \"COLINT\"", [i]));
+    }
+
+    return Promise.all(queries);
+  })
+  .then(function (results) {
+    results.forEach(function (rows, i) {
+      assert.deepEqual(rows, [{ COLINT: i }]);
+    });
+
+    var stats = db.threadPoolStats;
+
+    assert.equal(stats.threads, 4);
+    assert.equal(stats.queued, 0);
+    assert.equal(stats.running, 0);
+    assert.ok(stats.executed >= 17);
+    assert.ok(stats.peakQueued >= 1);
+
+    return db.close();
+  })
+  .catch(function (err) {
+    console.error(err);
+    process.exit(1);
+  });
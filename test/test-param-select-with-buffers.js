@@ -0,0 +1,59 @@
+var common = require("./common")
+  , odbc = require("../")
+  , db = new odbc.Database()
+  , assert = require("assert");
+
+var bytes = Buffer.from([0x00, 0xff, 0x10, 0x80, 0x7f]);
+
+// longer than a VARBINARY parameter may be on SQL Server
+var large = Buffer.alloc(20000);
+
+for (var i = 0; i < large.length; i++) {
+  large[i] = i % 251;
+}
+
+db.open(common.connectionString)
+  .then(function () {
+    return db.query("select ? as \"BUFFERCOL\", ? as \"ARRAYBUFFERCOL\"",
+      [bytes, new Uint8Array(bytes).buffer]);
+  })
+  .then(function (result) {
+    return result.fetchAll();
+  })
+  .then(function (data) {
+    assert.deepEqual(Buffer.from(data[0].BUFFERCOL), bytes);
+    assert.deepEqual(Buffer.from(data[0].ARRAYBUFFERCOL), bytes);
+
+    return db.query("select ? as \"LARGECOL\"", [large]);
+  })
+  .then(function (result) {
+    return result.fetchAll();
+  })
+  .then(function (data) {
+    assert.ok(Buffer.from(data[0].LARGECOL).equals(large));
+
+    // a failing query lets go of its Buffer parameters
+    var failing = Buffer.alloc(1024);
+    var ref = new WeakRef(failing);
+
+    return db.query("select ? from nowhere", [failing]).then(function () {
+      assert.fail("query should have been rejected");
+    }, function (err) {
+      assert.ok(err.message);
+      failing = null;
+
+      return new Promise(function (resolve) {
+        setTimeout(resolve, 10);
+      });
+    }).then(function () {
+      global.gc();
+      assert.equal(ref.deref(), undefined);
+    });
+  })
+  .then(function () {
+    return db.close();
+  })
+  .catch(function (err) {
+    console.error(err);
+    process.exit(1);
+  });
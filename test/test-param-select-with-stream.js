@@ -0,0 +1,59 @@
+var common = require("./common")
+  , odbc = require("../")
+  , db = new odbc.Database()
+  , assert = require("assert")
+  , Readable = require("stream").Readable;
+
+var chunks = [Buffer.from("node-"), Buffer.from("odbc-"), Buffer.from("stream")];
+
+db.open(common.connectionString)
+  .then(function () {
+    return db.query("select ? as \"STREAMCOL\"", [Readable.from(chunks)]);
+  })
+  .then(function (result) {
+    return result.fetchAll();
+  })
+  .then(function (data) {
+    assert.equal(Buffer.from(data[0].STREAMCOL).toString(), "node-odbc-stream");
+
+    // a source that never produces a chunk doesn't hold the query once it
+    // is aborted, and is told to release its resources
+    var controller = new AbortController()
+      , returned = false;
+
+    var stuck = {};
+    stuck[Symbol.asyncIterator] = function () {
+      return {
+        next: function () {
+          return new Promise(function () {});
+        },
+        return: function () {
+          returned = true;
+          return Promise.resolve({ done: true });
+        }
+      };
+    };
+
+    setTimeout(function () {
+      controller.abort();
+    }, 100);
+
+    return db.query("select ? as \"STREAMCOL\"", [stuck], { signal: controller.signal }).then(function () {
+      assert.fail("query should have been aborted");
+    }, function (err) {
+      assert.equal(err.name, "AbortError");
+
+      return new Promise(function (resolve) {
+        setTimeout(resolve, 50);
+      });
+    }).then(function () {
+      assert.equal(returned, true);
+    });
+  })
+  .then(function () {
+    return db.close();
+  })
+  .catch(function (err) {
+    console.error(err);
+    process.exit(1);
+  });
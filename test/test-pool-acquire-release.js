@@ -0,0 +1,59 @@
+var common = require("./common")
+  , odbc = require("../")
+  , pool = new odbc.Pool({ connectionString: common.connectionString, max: 2, acquireTimeout: 500 })
+  , assert = require("assert");
+
+var first, second, order = [];
+
+Promise.all([pool.acquire(), pool.acquire()])
+  .then(function (dbs) {
+    first = dbs[0];
+    second = dbs[1];
+
+    assert.notEqual(first, second);
+
+    // the pool is full: these wait, and are served in the order they asked
+    var third = pool.acquire().then(function (db) { order.push(3); return db; });
+    var fourth = pool.acquire().then(function (db) { order.push(4); return db; });
+
+    assert.equal(pool.stats.waiting, 2);
+
+    first.close();
+    second.close();
+
+    return Promise.all([third, fourth]);
+  })
+  .then(function (dbs) {
+    assert.deepEqual(order, [3, 4]);
+
+    // released connections are reused, not reopened
+    assert.ok(dbs.indexOf(first) !== -1 && dbs.indexOf(second) !== -1);
+    assert.equal(pool.stats.created, 2);
+
+    return dbs[0].queryAll("select 1 as \"COLINT\"").then(function (rows) {
+      assert.deepEqual(rows, [{ COLINT: 1 }]);
+
+      // nothing is released: the next caller times out
+      return pool.acquire().then(function () {
+        assert.fail("acquire should have timed out");
+      }, function (err) {
+        assert.ok(/Timed out/.test(err.message));
+        assert.equal(pool.stats.timeouts, 1);
+
+        return Promise.all(dbs.map(function (db) { return db.close(); }));
+      });
+    });
+  })
+  .then(function () {
+    assert.equal(pool.stats.idle, 2);
+    assert.equal(pool.stats.borrowed, 0);
+
+    return pool.close();
+  })
+  .then(function () {
+    assert.equal(pool.stats.size, 0);
+  })
+  .catch(function (err) {
+    console.error(err);
+    process.exit(1);
+  });
@@ -1,9 +1,9 @@
 var common = require("./common")
 	, odbc = require("../")
-	, pool = new odbc.Pool()
+	, connectCount = 10
+	, pool = new odbc.Pool({ max: connectCount + 1 })
 	, connectionString = common.connectionString
-	, connections = []
-	, connectCount = 10;
+	, connections = [];
 
 openConnectionsUsingPool(connections);
 
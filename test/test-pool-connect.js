@@ -1,9 +1,10 @@
 var common = require("./common")
 	, odbc = require("../")
-	, pool = new odbc.Pool()
+	, connectCount = 10
+	, pool = new odbc.Pool({ max: connectCount + 1 })
 	, connectionString = common.connectionString
 	, connections = []
-	, connectCount = 10;
+	, assert = require("assert");
 
 openConnectionsUsingPool(connections);
 
@@ -32,7 +33,13 @@ function openConnectionsUsingPool(connections) {
 }
 
 function closeConnections (connections) {
-	pool.close(function () {
-        console.error("pool closed");
-    });
+	// a pool only hands out connections to the string it was opened with
+	pool.open("DSN=someOtherDatabase", function (err, connection) {
+		assert.ok(err);
+		assert.equal(connection, undefined);
+
+		pool.close(function () {
+			console.error("pool closed");
+		});
+	});
 }
@@ -0,0 +1,55 @@
+var common = require("./common")
+  , odbc = require("../")
+  , assert = require("assert");
+
+// the least recently used entries go once there are more than maxEntries,
+// and a search pattern argument counts as matching any name
+var cache = new odbc.MetadataCache({ ttl: 0, maxEntries: 2 });
+
+cache.set("columns", [null, null, "A", null], []);
+cache.set("columns", [null, null, "B", null], []);
+cache.set("columns", [null, null, "C", null], []);
+assert.equal(cache.stats.size, 2);
+
+cache.set("tables", [null, null, "USER%", null], []);
+cache.invalidate({ table: "USERS" });
+assert.equal(cache.stats.size, 1);
+
+var pool = new odbc.Pool({ connectionString: common.connectionString, metadataCacheTtl: 0 });
+
+// the second tables() call, even on another connection, is served from the
+// pool's cache until it is invalidated
+pool.acquire()
+  .then(function (db) {
+    return db.tables(null, null, null, "TABLE").then(function (rows) {
+      assert.ok(Array.isArray(rows));
+      return db.close();
+    });
+  })
+  .then(function () {
+    return pool.acquire();
+  })
+  .then(function (db) {
+    return db.tables(null, null, null, "TABLE").then(function () {
+      assert.equal(pool.stats.metadataCache.misses, 1);
+      assert.equal(pool.stats.metadataCache.hits, 1);
+
+      pool.invalidateMetadata();
+
+      return db.tables(null, null, null, "TABLE");
+    }).then(function () {
+      assert.equal(pool.stats.metadataCache.misses, 2);
+      return db.close();
+    });
+  })
+  .then(function () {
+    return pool.prefetchMetadata(null, null);
+  })
+  .then(function (prefetched) {
+    assert.ok(prefetched.tables >= 0);
+    return pool.close();
+  })
+  .catch(function (err) {
+    console.error(err);
+    process.exit(1);
+  });
@@ -0,0 +1,58 @@
+var common = require("./common")
+  , odbc = require("../")
+  , assert = require("assert");
+
+var pool = new odbc.Pool({ connectionString: common.connectionString, max: 1 });
+
+// a connection released in the middle of a transaction is rolled back and
+// handed out again, not closed and reopened
+pool.acquire()
+  .then(function (db) {
+    return db.beginTransaction()
+      .then(function () { return db.queryAll("select 1 as \"COLINT\""); })
+      .then(function () { return db.close(); })
+      .then(function () { return db; });
+  })
+  .then(function (first) {
+    assert.equal(pool.stats.resets, 1);
+    assert.equal(pool.stats.resetFailures, 0);
+    assert.equal(pool.stats.idle, 1);
+
+    return pool.acquire().then(function (db) {
+      assert.strictEqual(db, first);
+      assert.equal(pool.stats.created, 1);
+      assert.equal(pool.stats.destroyed, 0);
+
+      // autocommit is back on, so there is no transaction to commit
+      return db.queryAll("select 1 as \"COLINT\"").then(function (rows) {
+        assert.deepEqual(rows, [{ COLINT: 1 }]);
+        return db.close();
+      });
+    });
+  })
+  .then(function () {
+    // results still open are left alone, another worker may be using them
+    var db = new odbc.Database();
+
+    return db.open(common.connectionString)
+      .then(function () { return db.query("select 1 as \"COLINT\""); })
+      .then(function (result) {
+        return db.reset()
+          .then(function (open) {
+            assert.ok(open >= 1);
+            return result.fetchAll();
+          })
+          .then(function (rows) {
+            assert.deepEqual(rows, [{ COLINT: 1 }]);
+            return result.close();
+          });
+      })
+      .then(function () { return db.close(); });
+  })
+  .then(function () {
+    return pool.close();
+  })
+  .catch(function (err) {
+    console.error(err);
+    process.exit(1);
+  });
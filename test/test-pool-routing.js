@@ -0,0 +1,63 @@
+var common = require("./common")
+  , odbc = require("../")
+  , assert = require("assert");
+
+assert.throws(function () {
+  new odbc.RoutingPool({ routing: "random" });
+});
+
+// reads are spread over the replicas in turn, everything else goes to the
+// primary
+odbc.pool({
+  connectionString: common.connectionString,
+  replicas: [common.connectionString, common.connectionString],
+  routing: "round-robin"
+})
+  .then(function (pool) {
+    var reads = [];
+
+    for (var i = 0; i < 4; i++) {
+      reads.push(pool.query("select ? as \"COLINT\"", [i], { readOnly: true }));
+    }
+
+    return Promise.all(reads)
+      .then(function (results) {
+        results.forEach(function (rows, i) {
+          assert.deepEqual(rows, [{ COLINT: i }]);
+        });
+
+        return pool.query("select 1 as \"COLINT\"");
+      })
+      .then(function () {
+        // query options other than readOnly reach the query
+        var controller = new AbortController();
+        controller.abort();
+
+        return pool.query("select 1 as \"COLINT\"", [], { signal: controller.signal }).then(function () {
+          assert.fail("query should have been aborted");
+        }, function (err) {
+          assert.equal(err.name, "AbortError");
+        });
+      })
+      .then(function () {
+        return pool.acquire({ readOnly: true });
+      })
+      .then(function (db) {
+        assert.equal(db.co.readOnly, true);
+        return db.close();
+      })
+      .then(function () {
+        var stats = pool.stats;
+
+        assert.equal(stats.primary.acquired, 2);
+        assert.equal(stats.replicas[0].acquired, 3);
+        assert.equal(stats.replicas[1].acquired, 2);
+        assert.ok(stats.replicas[0].latency !== null);
+
+        return pool.close();
+      });
+  })
+  .catch(function (err) {
+    console.error(err);
+    process.exit(1);
+  });
@@ -0,0 +1,38 @@
+var common = require("./common")
+  , odbc = require("../")
+  , assert = require("assert");
+
+var sql = "select ? as \"COLINT\"";
+
+// the pool is only handed over once its min connections are open, have run
+// initSql and have sql prepared
+odbc.pool({
+  connectionString: common.connectionString,
+  min: 3,
+  warmupConcurrency: 2,
+  initSql: ["select 1"],
+  cacheStatements: [sql]
+})
+  .then(function (pool) {
+    assert.equal(pool.stats.idle, 3);
+    assert.equal(pool.stats.created, 3);
+
+    return pool.acquire().then(function (db) {
+      assert.equal(db.statementCacheStats.size, 1);
+
+      return db.queryAll(sql, [1]).then(function (rows) {
+        assert.deepEqual(rows, [{ COLINT: 1 }]);
+
+        // served from the statement prepared during warm-up
+        assert.equal(db.statementCacheStats.hits, 1);
+
+        return db.close();
+      });
+    }).then(function () {
+      return pool.close();
+    });
+  })
+  .catch(function (err) {
+    console.error(err);
+    process.exit(1);
+  });
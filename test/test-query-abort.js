@@ -0,0 +1,67 @@
+var common = require("./common")
+  , odbc = require("../")
+  , db = new odbc.Database()
+  , assert = require("assert");
+
+// counts to rows on the server without touching any table: about a second
+// for 10 million rows
+function slow(rows) {
+  return "with recursive c(x) as (select 1 union all select x + 1 from c where x < " + rows + ") select count(*) as \"N\" from c";
+}
+
+db.open(common.connectionString)
+  .then(function () {
+    // a signal that has already aborted rejects without running anything
+    var controller = new AbortController();
+    controller.abort();
+
+    return db.query("select 1", [], { signal: controller.signal }).then(function () {
+      assert.fail("query should have been aborted");
+    }, function (err) {
+      assert.equal(err.name, "AbortError");
+      assert.equal(err.cancelled, true);
+    });
+  })
+  .then(function () {
+    // a signal that never aborts, and a timeout that isn't reached, change nothing
+    var controller = new AbortController();
+
+    return db.queryAll("select ? as \"COLINT\"", [1], { signal: controller.signal, timeout: 30 });
+  })
+  .then(function (data) {
+    assert.deepEqual(data, [{ COLINT: 1 }]);
+
+    // aborting while the statement executes cancels it with SQLCancel, and
+    // its handle goes back to the statement pool
+    var controller = new AbortController();
+
+    setTimeout(function () {
+      controller.abort();
+    }, 100);
+
+    return db.queryAll(slow(1000000000), [], { signal: controller.signal }).then(function () {
+      assert.fail("query should have been aborted");
+    }, function (err) {
+      assert.equal(err.name, "AbortError");
+      assert.equal(err.cancelled, true);
+      assert.equal(db.statementPoolStats.outstanding, 0);
+    });
+  })
+  .then(function () {
+    // a query that runs past its timeout fails with timedOut set. SQLite's
+    // driver only applies the timeout to lock waits, so there it may finish
+    return db.queryAll(slow(30000000), [], { timeout: 1 }).then(function () {
+      assert.equal(common.dialect, "sqlite");
+    }, function (err) {
+      assert.equal(err.timedOut, true);
+      assert.equal(err.cancelled, undefined);
+      assert.equal(db.statementPoolStats.outstanding, 0);
+    });
+  })
+  .then(function () {
+    return db.close();
+  })
+  .catch(function (err) {
+    console.error(err);
+    process.exit(1);
+  });
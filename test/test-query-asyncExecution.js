@@ -0,0 +1,33 @@
+var common = require("./common")
+  , odbc = require("../")
+  , db = new odbc.Database({ asyncExecution: true })
+  , assert = require("assert");
+
+// drivers without SQL_ATTR_ASYNC_ENABLE support fall back to the blocking
+// path, either way the results must be the same
+db.open(common.connectionString)
+  .then(function () {
+    return Promise.all([
+      db.queryAll("select ? as \"COLINT\"", [1]),
+      db.queryAll("select ? as \"COLINT\"", [2]),
+      db.queryAll("select ? as \"COLINT\"", [3])
+    ]);
+  })
+  .then(function (results) {
+    assert.deepEqual(results, [[{ COLINT: 1 }], [{ COLINT: 2 }], [{ COLINT: 3 }]]);
+
+    return db.queryAll("select bogus from nowhere").then(function () {
+      assert.fail("query should have been rejected");
+    }, function (err) {
+      assert.ok(err.message);
+    });
+  })
+  .then(function () {
+    assert.equal(db.statementPoolStats.outstanding, 0);
+
+    return db.close();
+  })
+  .catch(function (err) {
+    console.error(err);
+    process.exit(1);
+  });
@@ -0,0 +1,37 @@
+var common = require("./common")
+  , odbc = require("../")
+  , db = new odbc.Database({ statementCacheSize: 2 })
+  , assert = require("assert");
+
+function selectValue(value) {
+  return db.query("select ? as \"VALUECOL\"", [value])
+    .then(function (result) {
+      return result.fetchAll().then(function (data) {
+        return result.close().then(function () {
+          assert.equal(data[0].VALUECOL, value);
+        });
+      });
+    });
+}
+
+db.open(common.connectionString)
+  .then(function () {
+    assert.equal(db.co.statementCacheSize, 2);
+    return selectValue(1);
+  })
+  .then(function () {
+    return selectValue(2);
+  })
+  .then(function () {
+    var stats = db.statementCacheStats;
+
+    assert.equal(stats.size, 1);
+    assert.equal(stats.misses, 1);
+    assert.equal(stats.hits, 1);
+
+    return db.close();
+  })
+  .catch(function (err) {
+    console.error(err);
+    process.exit(1);
+  });
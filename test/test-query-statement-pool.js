@@ -0,0 +1,36 @@
+var common = require("./common")
+  , odbc = require("../")
+  , db = new odbc.Database({ statementPoolSize: 2 })
+  , assert = require("assert");
+
+function selectOne() {
+  return db.query("select 1 as \"ONECOL\"")
+    .then(function (result) {
+      return result.fetchAll().then(function () {
+        return result.close();
+      });
+    });
+}
+
+db.open(common.connectionString)
+  .then(function () {
+    assert.equal(db.co.statementPoolSize, 2);
+    return selectOne();
+  })
+  .then(function () {
+    return selectOne();
+  })
+  .then(function () {
+    var stats = db.statementPoolStats;
+
+    assert.equal(stats.outstanding, 0);
+    assert.equal(stats.idle, 1);
+    assert.equal(stats.allocations, 1);
+    assert.equal(stats.reuses, 1);
+
+    return db.close();
+  })
+  .catch(function (err) {
+    console.error(err);
+    process.exit(1);
+  });
@@ -0,0 +1,42 @@
+var common = require("./common")
+  , odbc = require("../")
+  , db = new odbc.Database()
+  , assert = require("assert");
+
+// each step of a query is stamped, in ms since it was queued
+db.open(common.connectionString)
+  .then(function () {
+    return db.co.query("select 1 as \"COLINT\"");
+  })
+  .then(function (result) {
+    var timings = result.timings;
+
+    assert.equal(timings.queued, 0);
+    assert.ok(timings.started >= 0);
+    assert.ok(timings.executed >= timings.started);
+    assert.ok(timings.bound >= timings.executed);
+    assert.equal(timings.fetched, undefined);
+
+    return result.fetchAll().then(function (rows) {
+      assert.deepEqual(rows, [{ COLINT: 1 }]);
+
+      timings = result.timings;
+      assert.ok(timings.fetchStarted >= timings.fetchQueued);
+      assert.ok(timings.materialized >= timings.fetched);
+      assert.equal(timings.total, timings.materialized);
+    });
+  })
+  .then(function () {
+    return db.queryAll("select * from doesNotExist").then(function () {
+      assert.fail("the query should have failed");
+    }, function (err) {
+      assert.ok(err.timings.executed >= 0);
+    });
+  })
+  .then(function () {
+    return db.close();
+  })
+  .catch(function (err) {
+    console.error(err);
+    process.exit(1);
+  });
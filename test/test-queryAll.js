@@ -0,0 +1,23 @@
+var common = require("./common")
+  , odbc = require("../")
+  , db = new odbc.Database()
+  , assert = require("assert");
+
+db.open(common.connectionString)
+  .then(function () {
+    return db.queryAll("select ? as \"COLINT\", ? as \"COLTEXT\"", [42, "fish"]);
+  })
+  .then(function (data) {
+    assert.deepEqual(data, [{ COLINT: 42, COLTEXT: "fish" }]);
+
+    return db.queryAll("select 1 as \"COLINT\"", { fetchMode: 3 });
+  })
+  .then(function (data) {
+    assert.deepEqual(data, [[1]]);
+
+    return db.close();
+  })
+  .catch(function (err) {
+    console.error(err);
+    process.exit(1);
+  });
@@ -0,0 +1,65 @@
+var common = require("./common")
+  , odbc = require("../")
+  , db = new odbc.Database()
+  , assert = require("assert");
+
+var statement;
+
+db.open(common.connectionString)
+  .then(function () {
+    return db.query("drop table if exists " + common.tableName);
+  })
+  .then(function () {
+    return db.query("create table " + common.tableName + " (COLINT INTEGER NOT NULL, COLDATETIME DATETIME, COLTEXT TEXT)");
+  })
+  .then(function () {
+    return db.co.createStatement();
+  })
+  .then(function (stmt) {
+    statement = stmt;
+    return statement.prepare("insert into " + common.tableName + " (COLINT, COLTEXT) values (?, ?)");
+  })
+  .then(function () {
+    return statement.executeMany([[1, "one"], [2, "two"], [3, "three"]]);
+  })
+  .then(function (rowCounts) {
+    assert.deepEqual(rowCounts, [1, 1, 1]);
+
+    // a failing set leaves the parameters bound with bind() in place
+    return statement.bind([4, "four"]);
+  })
+  .then(function () {
+    return statement.executeMany([[5, "five"], [null, "none"]]).then(function () {
+      assert.fail("executeMany should have been rejected");
+    }, function (err) {
+      assert.equal(err.index, 1);
+      assert.deepEqual(err.rowCounts, [1]);
+    });
+  })
+  .then(function () {
+    return statement.execute();
+  })
+  .then(function (result) {
+    return result.close();
+  })
+  .then(function () {
+    return db.queryAll("select COLINT, COLTEXT from " + common.tableName + " order by COLINT");
+  })
+  .then(function (data) {
+    assert.deepEqual(data, [
+      { COLINT: 1, COLTEXT: "one" },
+      { COLINT: 2, COLTEXT: "two" },
+      { COLINT: 3, COLTEXT: "three" },
+      { COLINT: 4, COLTEXT: "four" },
+      { COLINT: 5, COLTEXT: "five" }
+    ]);
+
+    return db.query("drop table " + common.tableName);
+  })
+  .then(function () {
+    return db.close();
+  })
+  .catch(function (err) {
+    console.error(err);
+    process.exit(1);
+  });
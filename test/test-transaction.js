@@ -0,0 +1,74 @@
+var common = require("./common")
+  , odbc = require("../")
+  , db = new odbc.Database()
+  , assert = require("assert");
+
+var insert = "insert into " + common.tableName + " (COLINT, COLTEXT) values (?, ?)";
+
+db.open(common.connectionString)
+  .then(function () {
+    return db.batch([
+      "drop table if exists " + common.tableName,
+      "create table " + common.tableName + " (COLINT INTEGER, COLDATETIME DATETIME, COLTEXT TEXT)"
+    ]);
+  })
+  .then(function () {
+    // only the four SQL_TXN_* levels are accepted
+    return db.transaction(["select 1"], { isolation: 3 }).then(function () {
+      assert.fail("transaction should have been rejected");
+    }, function (err) {
+      assert.ok(err instanceof TypeError);
+    });
+  })
+  .then(function () {
+    return db.transaction([
+      { sql: insert, params: [1, "one"] },
+      { sql: insert, params: [2, "two"] }
+    ], { isolation: "SERIALIZABLE" });
+  })
+  .then(function (results) {
+    assert.deepEqual(results, [1, 1]);
+
+    // the second statement fails, so the first one must be rolled back
+    return db.transaction([
+      { sql: insert, params: [3, "three"] },
+      "insert into nowhere values (1)"
+    ]).then(function () {
+      assert.fail("transaction should have been rejected");
+    }, function (err) {
+      assert.equal(err.index, 1);
+      assert.equal(err.rolledBack, true);
+    });
+  })
+  .then(function () {
+    // transaction() refuses to end a transaction the caller began, which
+    // stays open and is rolled back by the caller
+    return db.beginTransaction()
+      .then(function () {
+        return db.batch([{ sql: insert, params: [4, "four"] }]);
+      })
+      .then(function () {
+        return db.transaction([{ sql: insert, params: [5, "five"] }]);
+      })
+      .then(function () {
+        assert.fail("transaction should have been rejected");
+      }, function (err) {
+        assert.equal(err.rolledBack, false);
+        return db.rollbackTransaction();
+      });
+  })
+  .then(function () {
+    return db.queryAll("select COLINT from " + common.tableName + " order by COLINT");
+  })
+  .then(function (data) {
+    assert.deepEqual(data, [{ COLINT: 1 }, { COLINT: 2 }]);
+
+    return db.batch(["drop table " + common.tableName]);
+  })
+  .then(function () {
+    return db.close();
+  })
+  .catch(function (err) {
+    console.error(err);
+    process.exit(1);
+  });